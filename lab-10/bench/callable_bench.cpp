@@ -0,0 +1,58 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "lib/scheduler.h"
+#include "legacy_scheduler.h"
+
+// Cost of add() and executeAll() for tiny tasks, with heap allocations counted by
+// replacing the global operator new.
+// Usage: callable_bench [tasks]
+
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+template<typename Scheduler>
+static void measure(const char* name, size_t tasks) {
+    Scheduler scheduler;
+    int offset = 1;
+
+    size_t before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < tasks; ++i) {
+        scheduler.add([offset](int a) { return a + offset; }, int(i));
+    }
+    auto added = std::chrono::steady_clock::now();
+    size_t addAllocations = allocations.load() - before;
+
+    scheduler.executeAll();
+    auto executed = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double, std::nano> addTime = added - start;
+    std::chrono::duration<double, std::nano> executeTime = executed - added;
+    std::cout << name << ": add " << addTime.count() / tasks << " ns/task, "
+        << addAllocations << " allocations; execute " << executeTime.count() / tasks << " ns/task" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    measure<legacy::TTaskScheduler>("legacy shared_ptr callable", tasks);
+    measure<TTaskScheduler>("small-buffer callable", tasks);
+}
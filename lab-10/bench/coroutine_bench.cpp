@@ -0,0 +1,153 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <queue>
+#include <string>
+
+#include "lib/scheduler.h"
+
+// I/O-bound tasks on a small pool: tasks that block a worker for every read against
+// coroutine tasks that suspend on a TEvent until a simulated device completes it.
+// Usage: coroutine_bench [tasks] [threads] [reads per task] [latency, us]
+
+// Completes every submitted request after a fixed latency, from its own thread.
+class TFakeDevice {
+public:
+    explicit TFakeDevice(std::chrono::microseconds latency) : latency_(latency), thread_([this] { loop(); }) {}
+
+    ~TFakeDevice() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    void submit(TEvent& done) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requests_.push({std::chrono::steady_clock::now() + latency_, &done});
+        }
+        wake_.notify_one();
+    }
+
+private:
+    struct TRequest {
+        std::chrono::steady_clock::time_point deadline;
+        TEvent* done;
+
+        bool operator>(const TRequest& other) const {
+            return deadline > other.deadline;
+        }
+    };
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_ || !requests_.empty()) {
+            if (requests_.empty()) {
+                wake_.wait(lock);
+                continue;
+            }
+            TRequest next = requests_.top();
+            if (std::chrono::steady_clock::now() < next.deadline) {
+                wake_.wait_until(lock, next.deadline);
+                continue;
+            }
+            requests_.pop();
+            lock.unlock();
+            next.done->set();
+            lock.lock();
+        }
+    }
+
+    std::chrono::microseconds latency_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::priority_queue<TRequest, std::vector<TRequest>, std::greater<TRequest>> requests_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+struct TInFlight {
+    std::atomic<size_t> current{0};
+    std::atomic<size_t> peak{0};
+
+    void enter() {
+        size_t now = current.fetch_add(1) + 1;
+        size_t seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+        }
+    }
+
+    void leave() {
+        current.fetch_sub(1);
+    }
+};
+
+static void report(const char* name, size_t tasks, size_t threads, double ms, size_t peak) {
+    std::cout << name << ": " << tasks << " tasks on " << threads << " thread(s) in " << ms << " ms, "
+        << tasks / ms * 1000 << " tasks/s, at most " << peak << " in flight" << std::endl;
+}
+
+static void blocking(size_t tasks, size_t threads, size_t reads, std::chrono::microseconds latency) {
+    TInFlight inFlight;
+    auto start = std::chrono::steady_clock::now();
+    {
+        TTaskScheduler scheduler(threads);
+        for (size_t i = 0; i < tasks; ++i) {
+            scheduler.add([&inFlight, reads, latency](size_t i) {
+                inFlight.enter();
+                size_t sum = i;
+                for (size_t r = 0; r < reads; ++r) {
+                    std::this_thread::sleep_for(latency);
+                    sum += r;
+                }
+                inFlight.leave();
+                return sum;
+            }, i);
+        }
+        scheduler.executeAll();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    report("blocking reads", tasks, threads, elapsed.count(), inFlight.peak.load());
+}
+
+static void coroutines(size_t tasks, size_t threads, size_t reads, std::chrono::microseconds latency) {
+    TInFlight inFlight;
+    TFakeDevice device(latency);
+    auto start = std::chrono::steady_clock::now();
+    {
+        TTaskScheduler scheduler(threads);
+        for (size_t i = 0; i < tasks; ++i) {
+            scheduler.add([&inFlight, &device, reads](size_t i) -> TTask<size_t> {
+                inFlight.enter();
+                size_t sum = i;
+                for (size_t r = 0; r < reads; ++r) {
+                    TEvent done;
+                    device.submit(done);
+                    co_await done;
+                    sum += r;
+                }
+                inFlight.leave();
+                co_return sum;
+            }, i);
+        }
+        scheduler.executeAll();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    report("co_await reads", tasks, threads, elapsed.count(), inFlight.peak.load());
+}
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    size_t reads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4;
+    std::chrono::microseconds latency(argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 2000);
+
+    // Blocking tasks need tasks * reads * latency / threads; keep that run short.
+    blocking(std::min<size_t>(tasks, threads * 100), threads, reads, latency);
+    coroutines(tasks, threads, reads, latency);
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "lib/scheduler.h"
+
+// Makespan of unbalanced DAGs with FIFO and critical-path dispatch. Task bodies sleep
+// by default, so the effect of ordering shows even on a machine with fewer cores than
+// workers; pass "spin" to burn CPU instead.
+// Usage: dispatch_bench [threads] [sleep|spin]
+
+static bool spinning = false;
+
+static int work(double ms) {
+    if (!spinning) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ms));
+        return 1;
+    }
+    auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(ms);
+    int spins = 0;
+    while (std::chrono::steady_clock::now() < until) {
+        ++spins;
+    }
+    return spins > 0;
+}
+
+struct TDag {
+    std::vector<double> cost;
+    std::vector<std::vector<size_t>> inputs;
+
+    double criticalPath() const {
+        std::vector<double> finish(cost.size());
+        double longest = 0;
+        for (size_t i = 0; i < cost.size(); ++i) {
+            double start = 0;
+            for (size_t input : inputs[i]) {
+                start = std::max(start, finish[input]);
+            }
+            finish[i] = start + cost[i];
+            longest = std::max(longest, finish[i]);
+        }
+        return longest;
+    }
+
+    double total() const {
+        double sum = 0;
+        for (double c : cost) {
+            sum += c;
+        }
+        return sum;
+    }
+};
+
+// One long chain whose head is added in the middle of many short independent tasks.
+static TDag chainAmongShortTasks() {
+    TDag dag;
+    auto addShort = [&dag](size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            dag.cost.push_back(1.0);
+            dag.inputs.push_back({});
+        }
+    };
+    addShort(100);
+    for (size_t i = 0; i < 30; ++i) {
+        dag.cost.push_back(2.0);
+        dag.inputs.push_back(i == 0 ? std::vector<size_t>{} : std::vector<size_t>{dag.cost.size() - 2});
+    }
+    addShort(100);
+    return dag;
+}
+
+// Random DAG in layers; a few tasks are much costlier than the rest.
+static TDag randomLayered(size_t layers, size_t width, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    TDag dag;
+    for (size_t layer = 0; layer < layers; ++layer) {
+        size_t begin = dag.cost.size();
+        for (size_t i = 0; i < width; ++i) {
+            dag.cost.push_back(unit(random) < 0.1 ? 4.0 + 4.0 * unit(random) : 0.2 + 0.6 * unit(random));
+            std::vector<size_t> inputs;
+            if (layer > 0) {
+                size_t previous = begin - width;
+                size_t fanIn = 1 + random() % 3;
+                for (size_t k = 0; k < fanIn; ++k) {
+                    inputs.push_back(previous + random() % width);
+                }
+            }
+            dag.inputs.push_back(inputs);
+        }
+    }
+    return dag;
+}
+
+static double makespan(const TDag& dag, size_t threads, EDispatchOrder order) {
+    TTaskScheduler scheduler(threads);
+    scheduler.setDispatchOrder(order);
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < dag.cost.size(); ++i) {
+        double ms = dag.cost[i];
+        // The generators above give a task at most three inputs.
+        const std::vector<size_t>& in = dag.inputs[i];
+        size_t id;
+        if (in.empty()) {
+            id = scheduler.add([ms]() { return work(ms); });
+        } else if (in.size() == 1) {
+            id = scheduler.add([ms](int) { return work(ms); }, scheduler.getFutureResult<int>(ids[in[0]]));
+        } else if (in.size() == 2) {
+            id = scheduler.add([ms](int, int) { return work(ms); },
+                scheduler.getFutureResult<int>(ids[in[0]]), scheduler.getFutureResult<int>(ids[in[1]]));
+        } else {
+            id = scheduler.add([ms](int, int, int) { return work(ms); }, scheduler.getFutureResult<int>(ids[in[0]]),
+                scheduler.getFutureResult<int>(ids[in[1]]), scheduler.getFutureResult<int>(ids[in[2]]));
+        }
+        scheduler.setCost(id, float(ms));
+        ids.push_back(id);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.executeAll();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static void report(const char* name, const TDag& dag, size_t threads) {
+    // executeAll() lends the calling thread to the pool, so threads + 1 run tasks.
+    double bound = std::max(dag.criticalPath(), dag.total() / double(threads + 1));
+    double fifo = makespan(dag, threads, EDispatchOrder::Fifo);
+    double critical = makespan(dag, threads, EDispatchOrder::CriticalPath);
+    std::cout << name << ", " << threads << " worker(s): lower bound " << bound << " ms, fifo " << fifo
+        << " ms, critical path " << critical << " ms" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 3;
+    spinning = argc > 2 && std::strcmp(argv[2], "spin") == 0;
+
+    report("chain among short tasks", chainAmongShortTasks(), threads);
+    report("random layered", randomLayered(20, 24, 1), threads);
+    report("random layered", randomLayered(20, 24, 2), threads);
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <chrono>
+#include <cstdlib>
+
+#include "lib/scheduler.h"
+#include "lib/task_graph.h"
+#include "legacy_scheduler.h"
+
+// Solving many quadratic equations with the lab's six-task pipeline: rebuilding the
+// DAG every time (legacy and current scheduler) against replaying a recorded graph.
+// A second case compares rebuilding a wide graph on a pool with replaying it serially
+// and on a pool.
+// Usage: graph_bench [iterations] [threads]
+
+struct TCoefficients {
+    float a;
+    float b;
+    float c;
+};
+
+static TCoefficients coefficients(size_t i) {
+    return {1.0f, -float(i % 100), -float(i % 7)};
+}
+
+template<typename Scheduler>
+static float rebuild(const TCoefficients& k) {
+    Scheduler scheduler;
+    auto id1 = scheduler.add([](float a, float c) { return -4 * a * c; }, k.a, k.c);
+    auto id2 = scheduler.add([&scheduler, id1](float b) { return b * b + scheduler.template getResult<float>(id1); }, k.b);
+    auto id3 = scheduler.add([&scheduler, id2](float b) { return -b + std::sqrt(scheduler.template getResult<float>(id2)); }, k.b);
+    auto id4 = scheduler.add([&scheduler, id2](float b) { return -b - std::sqrt(scheduler.template getResult<float>(id2)); }, k.b);
+    auto id5 = scheduler.add([&scheduler, id3](float a) { return scheduler.template getResult<float>(id3) / (2 * a); }, k.a);
+    auto id6 = scheduler.add([&scheduler, id4](float a) { return scheduler.template getResult<float>(id4) / (2 * a); }, k.a);
+    scheduler.executeAll();
+    return scheduler.template getResult<float>(id5) + scheduler.template getResult<float>(id6);
+}
+
+// The same pipeline with the current scheduler's FutureResult dependencies.
+static float rebuildWithFutures(const TCoefficients& k) {
+    TTaskScheduler scheduler;
+    auto id1 = scheduler.add([](float a, float c) { return -4 * a * c; }, k.a, k.c);
+    auto id2 = scheduler.add([](float b, float v) { return b * b + v; }, k.b, scheduler.getFutureResult<float>(id1));
+    auto id3 = scheduler.add([](float b, float d) { return -b + std::sqrt(d); }, k.b, scheduler.getFutureResult<float>(id2));
+    auto id4 = scheduler.add([](float b, float d) { return -b - std::sqrt(d); }, k.b, scheduler.getFutureResult<float>(id2));
+    auto id5 = scheduler.add([](float a, float v) { return v / (2 * a); }, k.a, scheduler.getFutureResult<float>(id3));
+    auto id6 = scheduler.add([](float a, float v) { return v / (2 * a); }, k.a, scheduler.getFutureResult<float>(id4));
+    scheduler.executeAll();
+    return scheduler.getResult<float>(id5) + scheduler.getResult<float>(id6);
+}
+
+template<typename Body>
+static void report(const char* name, size_t iterations, Body body) {
+    float checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        checksum += body(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() / iterations << " ns per graph (checksum " << checksum << ")" << std::endl;
+}
+
+static void quadratic(size_t iterations) {
+    report("legacy scheduler, rebuild", iterations, [](size_t i) { return rebuild<legacy::TTaskScheduler>(coefficients(i)); });
+    report("scheduler, rebuild", iterations, [](size_t i) { return rebuildWithFutures(coefficients(i)); });
+
+    TTaskGraph graph;
+    auto a = graph.input<float>();
+    auto b = graph.input<float>();
+    auto c = graph.input<float>();
+    auto id1 = graph.add([](float a, float c) { return -4 * a * c; }, a, c);
+    auto id2 = graph.add([](float b, float v) { return b * b + v; }, b, graph.getFutureResult<float>(id1));
+    auto id3 = graph.add([](float b, float d) { return -b + std::sqrt(d); }, b, graph.getFutureResult<float>(id2));
+    auto id4 = graph.add([](float b, float d) { return -b - std::sqrt(d); }, b, graph.getFutureResult<float>(id2));
+    auto id5 = graph.add([](float a, float v) { return v / (2 * a); }, a, graph.getFutureResult<float>(id3));
+    auto id6 = graph.add([](float a, float v) { return v / (2 * a); }, a, graph.getFutureResult<float>(id4));
+    graph.freeze();
+
+    report("task graph, replay", iterations, [&](size_t i) {
+        TCoefficients k = coefficients(i);
+        graph.setInput(a, k.a);
+        graph.setInput(b, k.b);
+        graph.setInput(c, k.c);
+        graph.run();
+        return graph.getResult<float>(id5) + graph.getResult<float>(id6);
+    });
+}
+
+// `width` leaves summed pairwise, on a pool of `threads` workers.
+static void wide(size_t iterations, size_t threads) {
+    const size_t width = 256;
+    iterations = std::max<size_t>(iterations / 1000, 1);
+
+    report("wide graph, scheduler rebuild", iterations, [&](size_t i) {
+        TTaskScheduler scheduler(threads);
+        std::vector<size_t> level;
+        for (size_t leaf = 0; leaf < width; ++leaf) {
+            level.push_back(scheduler.add([](float x, float y) { return x * y; }, float(leaf), float(i % 3)));
+        }
+        while (level.size() > 1) {
+            std::vector<size_t> next;
+            for (size_t j = 0; j < level.size(); j += 2) {
+                next.push_back(scheduler.add([](float x, float y) { return x + y; },
+                    scheduler.getFutureResult<float>(level[j]), scheduler.getFutureResult<float>(level[j + 1])));
+            }
+            level.swap(next);
+        }
+        scheduler.executeAll();
+        return scheduler.getResult<float>(level[0]);
+    });
+
+    TTaskGraph graph;
+    auto scale = graph.input<float>();
+    std::vector<size_t> level;
+    for (size_t leaf = 0; leaf < width; ++leaf) {
+        level.push_back(graph.add([](float x, float y) { return x * y; }, float(leaf), scale));
+    }
+    while (level.size() > 1) {
+        std::vector<size_t> next;
+        for (size_t j = 0; j < level.size(); j += 2) {
+            next.push_back(graph.add([](float x, float y) { return x + y; },
+                graph.getFutureResult<float>(level[j]), graph.getFutureResult<float>(level[j + 1])));
+        }
+        level.swap(next);
+    }
+
+    report("wide graph, replay serial", iterations, [&](size_t i) {
+        graph.setInput(scale, float(i % 3));
+        graph.run();
+        return graph.getResult<float>(level[0]);
+    });
+
+    TWorkStealingPool pool(threads);
+    report("wide graph, replay on pool", iterations, [&](size_t i) {
+        graph.setInput(scale, float(i % 3));
+        graph.run(pool);
+        return graph.getResult<float>(level[0]);
+    });
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2;
+
+    quadratic(iterations);
+    wide(iterations, threads);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <cstdlib>
+
+#include "lib/scheduler.h"
+
+// Fine-grained loops: one task per element against one parallel loop task, for a cheap
+// body (a few flops) and a costlier one, next to a plain serial loop.
+// Usage: loop_bench [elements] [threads]
+
+static double body(size_t i, size_t work) {
+    double x = double(i);
+    for (size_t k = 0; k < work; ++k) {
+        x = x * 0.5 + 1.0;
+    }
+    return x;
+}
+
+template<typename Workload>
+static void report(const char* name, size_t elements, Workload workload) {
+    auto start = std::chrono::steady_clock::now();
+    double checksum = workload();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() / elements << " ns per element, "
+        << elements / elapsed.count() * 1e3 << " M elements/s (checksum " << checksum << ")" << std::endl;
+}
+
+static void run(size_t elements, size_t threads, size_t work) {
+    std::cout << "work " << work << ":" << std::endl;
+    std::vector<double> out(elements);
+    report("  serial loop", elements, [&] {
+        double sum = 0;
+        for (size_t i = 0; i < elements; ++i) {
+            sum += body(i, work);
+        }
+        return sum;
+    });
+
+    report("  task per element, for", elements, [&] {
+        TTaskScheduler scheduler(threads);
+        for (size_t i = 0; i < elements; ++i) {
+            scheduler.add([&out, i, work]() { out[i] = body(i, work); });
+        }
+        scheduler.executeAll();
+        return out[elements - 1];
+    });
+
+    report("  parallel for", elements, [&] {
+        TTaskScheduler scheduler(threads);
+        scheduler.addParallelFor({0, elements}, [&out, work](size_t i) { out[i] = body(i, work); });
+        scheduler.executeAll();
+        return out[elements - 1];
+    });
+
+    report("  parallel reduce", elements, [&] {
+        TTaskScheduler scheduler(threads);
+        auto sum = scheduler.addParallelReduce({0, elements}, 0.0, [work](size_t i) { return body(i, work); },
+            [](double a, double b) { return a + b; });
+        scheduler.executeAll();
+        return scheduler.getResult<double>(sum);
+    });
+}
+
+int main(int argc, char* argv[]) {
+    size_t elements = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2;
+
+    run(elements, threads, 4);
+    run(elements / 10, threads, 400);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cstdlib>
+
+#include "lib/scheduler.h"
+
+// Quadratic equations whose coefficients repeat: `distinct` different triples among
+// `equations`, each solved by the lab's six-task pipeline, with memoization off and on.
+// The tasks burn `work` iterations on top of their arithmetic; with work 0 the numbers
+// show the cost of hashing and lookups, with all triples distinct only that cost.
+// Usage: memo_bench [equations] [threads]
+
+static size_t work = 0;
+
+static float burn(float x) {
+    for (size_t i = 0; i < work; ++i) {
+        x = x * 0.999f + 0.001f;
+    }
+    return x;
+}
+
+static float discriminantPart(float a, float c) {
+    return burn(-4 * a * c);
+}
+
+static float discriminant(float b, float part) {
+    return burn(b * b + part);
+}
+
+static float plusRoot(float b, float d) {
+    return burn(-b + std::sqrt(d));
+}
+
+static float minusRoot(float b, float d) {
+    return burn(-b - std::sqrt(d));
+}
+
+static float divide(float a, float v) {
+    return burn(v / (2 * a));
+}
+
+static double solveAll(size_t equations, size_t distinct, size_t threads, bool memoize) {
+    TTaskScheduler scheduler(threads);
+    if (memoize) {
+        scheduler.enableMemoization();
+    }
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < equations; ++i) {
+        float a = 1.0f;
+        float b = -float(i % distinct);
+        float c = -float(i % distinct % 7);
+        auto id1 = scheduler.add(&discriminantPart, a, c);
+        auto id2 = scheduler.add(&discriminant, b, scheduler.getFutureResult<float>(id1));
+        auto id3 = scheduler.add(&plusRoot, b, scheduler.getFutureResult<float>(id2));
+        auto id4 = scheduler.add(&minusRoot, b, scheduler.getFutureResult<float>(id2));
+        roots.push_back(scheduler.add(&divide, a, scheduler.getFutureResult<float>(id3)));
+        roots.push_back(scheduler.add(&divide, a, scheduler.getFutureResult<float>(id4)));
+    }
+    scheduler.executeAll();
+    double checksum = 0;
+    for (size_t id : roots) {
+        checksum += scheduler.getResult<float>(id);
+    }
+    if (memoize) {
+        std::cout << " (hit rate " << scheduler.memoStats().hitRate() * 100 << "%)";
+    }
+    return checksum;
+}
+
+static void report(size_t equations, size_t distinct, size_t threads) {
+    std::cout << equations << " equations, " << distinct << " distinct, work " << work << ":" << std::endl;
+    for (bool memoize : {false, true}) {
+        std::cout << (memoize ? "  memoized" : "  plain   ");
+        auto start = std::chrono::steady_clock::now();
+        double checksum = solveAll(equations, distinct, threads, memoize);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << ": " << elapsed.count() << " ms (checksum " << checksum << ")" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t equations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2;
+
+    report(equations, 100, threads);
+    report(equations, equations, threads);
+    work = 2000;
+    report(equations, 100, threads);
+    report(equations, equations, threads);
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include "lib/scheduler.h"
+#include "legacy_scheduler.h"
+
+// Per-task cost of add + executeAll + reading the result, for tiny and large results.
+// Usage: overhead_bench [tasks]
+
+template<typename Scheduler>
+static void tinyTasks(const char* name, size_t tasks) {
+    auto start = std::chrono::steady_clock::now();
+    Scheduler scheduler;
+    for (size_t i = 0; i < tasks; ++i) {
+        scheduler.add([](int a) { return a + 1; }, int(i));
+    }
+    scheduler.executeAll();
+    long long checksum = 0;
+    for (size_t i = 0; i < tasks; ++i) {
+        checksum += scheduler.template getResult<int>(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << ": " << elapsed.count() / tasks << " ns/task (checksum " << checksum << ")" << std::endl;
+}
+
+template<typename Read>
+static void largeTasks(const char* name, size_t tasks, Read read) {
+    auto start = std::chrono::steady_clock::now();
+    TTaskScheduler scheduler;
+    for (size_t i = 0; i < tasks; ++i) {
+        scheduler.add([](size_t n) { return std::vector<int>(n, 1); }, size_t(256));
+    }
+    scheduler.executeAll();
+    size_t checksum = 0;
+    for (size_t i = 0; i < tasks; ++i) {
+        checksum += read(scheduler, i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << ": " << elapsed.count() / tasks << " ns/task (checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    tinyTasks<legacy::TTaskScheduler>("tiny int results, legacy int8_t* slots", tasks);
+    tinyTasks<TTaskScheduler>("tiny int results, inline result slots", tasks);
+
+    largeTasks("vector<int>(256) results, getResult copy", tasks / 10, [](TTaskScheduler& scheduler, size_t id) {
+        return scheduler.getResult<std::vector<int>>(id).size();
+    });
+    largeTasks("vector<int>(256) results, getResultRef", tasks / 10, [](TTaskScheduler& scheduler, size_t id) {
+        return scheduler.getResultRef<std::vector<int>>(id).size();
+    });
+    largeTasks("vector<int>(256) results, takeResult", tasks / 10, [](TTaskScheduler& scheduler, size_t id) {
+        return scheduler.takeResult<std::vector<int>>(id).size();
+    });
+}
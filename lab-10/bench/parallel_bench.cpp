@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include "lib/scheduler.h"
+
+// Serial vs. parallel executeAll on wide and deep DAGs.
+// Usage: parallel_bench [tasks] [work per task]
+
+static double busyWork(double seed, size_t work) {
+    double x = seed;
+    for (size_t i = 0; i < work; ++i) {
+        x = std::sqrt(x * x + 1.0);
+    }
+    return x;
+}
+
+// `tasks` independent leaves combined by a binary tree of reductions.
+static double wide(TTaskScheduler& scheduler, size_t tasks, size_t work) {
+    std::vector<size_t> level;
+    for (size_t i = 0; i < tasks; ++i) {
+        level.push_back(scheduler.add([work](double seed) { return busyWork(seed, work); }, double(i)));
+    }
+    while (level.size() > 1) {
+        std::vector<size_t> next;
+        for (size_t i = 0; i + 1 < level.size(); i += 2) {
+            next.push_back(scheduler.add([](double a, double b) { return a + b; },
+                scheduler.getFutureResult<double>(level[i]), scheduler.getFutureResult<double>(level[i + 1])));
+        }
+        if (level.size() % 2) {
+            next.push_back(level.back());
+        }
+        level.swap(next);
+    }
+    scheduler.executeAll();
+    return scheduler.getResult<double>(level[0]);
+}
+
+// Eight independent chains; only the chains themselves can run in parallel.
+static double deep(TTaskScheduler& scheduler, size_t tasks, size_t work) {
+    const size_t chains = 8;
+    std::vector<size_t> tails;
+    for (size_t c = 0; c < chains; ++c) {
+        size_t id = scheduler.add([work](double seed) { return busyWork(seed, work); }, double(c));
+        for (size_t i = 1; i < tasks / chains; ++i) {
+            id = scheduler.add([work](double seed) { return busyWork(seed, work); }, scheduler.getFutureResult<double>(id));
+        }
+        tails.push_back(id);
+    }
+    scheduler.executeAll();
+    double sum = 0;
+    for (size_t id : tails) {
+        sum += scheduler.getResult<double>(id);
+    }
+    return sum;
+}
+
+template<typename Workload>
+static void report(const char* name, size_t threads, Workload workload) {
+    auto start = std::chrono::steady_clock::now();
+    TTaskScheduler scheduler(threads);
+    double checksum = workload(scheduler);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << ", " << (threads ? std::to_string(threads) + " thread(s)" : std::string("serial"))
+        << ": " << elapsed.count() << " ms (checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    size_t work = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000;
+
+    std::vector<size_t> threadCounts = {0};
+    size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    for (size_t threads = 1; threads < hardware; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardware);
+
+    for (size_t threads : threadCounts) {
+        report("wide", threads, [&](TTaskScheduler& scheduler) { return wide(scheduler, tasks, work); });
+    }
+    for (size_t threads : threadCounts) {
+        report("deep", threads, [&](TTaskScheduler& scheduler) { return deep(scheduler, tasks, work); });
+    }
+}
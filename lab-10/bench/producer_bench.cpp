@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+
+#include "lib/scheduler.h"
+#include "legacy_scheduler.h"
+
+// Several threads adding tasks to one scheduler at once, and several threads reading
+// the same results while they are being computed.
+// Usage: producer_bench [tasks per producer] [max producers]
+
+template<typename Function>
+static double timeThreads(size_t threads, Function body) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back(body, t);
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Each producer adds independent tiny tasks.
+static void concurrentAdd(size_t producers, size_t tasks) {
+    TTaskScheduler scheduler;
+    double ms = timeThreads(producers, [&scheduler, tasks](size_t p) {
+        for (size_t i = 0; i < tasks; ++i) {
+            scheduler.add([](size_t a) { return a + 1; }, p + i);
+        }
+    });
+
+    // The legacy scheduler is not thread-safe, so every add() goes through one mutex.
+    legacy::TTaskScheduler legacyScheduler;
+    std::mutex mutex;
+    double legacyMs = timeThreads(producers, [&legacyScheduler, &mutex, tasks](size_t p) {
+        for (size_t i = 0; i < tasks; ++i) {
+            std::lock_guard<std::mutex> lock(mutex);
+            legacyScheduler.add([](size_t a) { return a + 1; }, p + i);
+        }
+    });
+
+    double total = double(producers * tasks);
+    std::cout << "add, " << producers << " producer(s): " << total / ms / 1000 << " M tasks/s"
+        << " (legacy + mutex: " << total / legacyMs / 1000 << " M tasks/s)" << std::endl;
+}
+
+static double busyWork(size_t seed, size_t work) {
+    double x = double(seed);
+    for (size_t i = 0; i < work; ++i) {
+        x = std::sqrt(x * x + 1.0);
+    }
+    return x;
+}
+
+// Readers race for the same chain tails: the first one to reach a task runs it and
+// the others wait for it with the given policy.
+static void sharedReads(EWaitPolicy policy, const char* name, size_t readers, size_t tasks) {
+    const size_t chains = 4;
+    const size_t work = 2000;
+    TTaskScheduler scheduler(2, policy);
+
+    std::vector<size_t> tails;
+    for (size_t c = 0; c < chains; ++c) {
+        size_t id = scheduler.add([work](size_t seed) { return busyWork(seed, work); }, c);
+        for (size_t i = 1; i < tasks / 16; ++i) {
+            id = scheduler.add([work](double a) { return busyWork(size_t(a) % 7, work) + a; }, scheduler.getFutureResult<double>(id));
+        }
+        tails.push_back(id);
+    }
+
+    double checksum = 0;
+    std::mutex mutex;
+    double ms = timeThreads(readers, [&](size_t r) {
+        double sum = 0;
+        for (size_t c = 0; c < chains; ++c) {
+            sum += scheduler.getResult<double>(tails[(r + c) % chains]);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        checksum += sum;
+    });
+
+    std::cout << "getResult, " << readers << " reader(s), " << name << ": " << ms << " ms (checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    size_t maxProducers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+
+    for (size_t producers = 1; producers <= maxProducers; producers *= 2) {
+        concurrentAdd(producers, tasks);
+    }
+    for (size_t readers : {size_t(2), size_t(8)}) {
+        sharedReads(EWaitPolicy::Spin, "spin", readers, tasks);
+        sharedReads(EWaitPolicy::Block, "block", readers, tasks);
+        sharedReads(EWaitPolicy::Help, "help", readers, tasks);
+    }
+    return 0;
+}
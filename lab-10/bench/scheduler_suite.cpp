@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "lib/scheduler.h"
+#include "workloads.h"
+
+// Regression suite for TTaskScheduler: every generated DAG with tiny and heavy task
+// bodies, on each thread count (0 runs serially on the calling thread). Prints one
+// record per case as CSV, or as JSON lines with --json, so that runs can be diffed or
+// fed to a dashboard. Times are medians over the repetitions.
+//
+// Columns: add_ns is the cost of add() per task, exec_ns the executeAll() time per task,
+// makespan_ms the executeAll() time of the whole graph, speedup the serial makespan over
+// this one, and memory_bytes what the scheduler held per task afterwards.
+//
+// Usage: scheduler_suite [--json] [--tasks N] [--threads 0,1,2,4] [--repeat R]
+
+struct TOptions {
+    bool json = false;
+    size_t tasks = 100000;
+    std::vector<size_t> threads{0, 1, 2, 4};
+    size_t repeat = 5;
+};
+
+struct TResult {
+    double addNanos;
+    double executeNanos;
+    size_t memory;
+};
+
+enum class EBody {
+    Tiny,
+    Heavy,
+};
+
+// Some tens of microseconds per heavy task.
+static constexpr size_t kHeavyWork = 20000;
+
+static uint64_t heavy(uint64_t x) {
+    for (size_t i = 0; i < kHeavyWork; ++i) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    return x;
+}
+
+template<EBody Body>
+static uint64_t run(uint64_t a, uint64_t b) {
+    uint64_t value = a + b + 1;
+    if constexpr (Body == EBody::Heavy) {
+        value = heavy(value);
+    }
+    return value;
+}
+
+template<EBody Body>
+static TResult measure(const TDagWorkload& dag, size_t threads) {
+    TTaskScheduler scheduler(threads);
+    std::vector<size_t> ids(dag.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < dag.size(); ++i) {
+        const std::vector<size_t>& in = dag.inputs[i];
+        if (in.empty()) {
+            ids[i] = scheduler.add(&run<Body>, uint64_t(i), uint64_t(0));
+        } else if (in.size() == 1) {
+            ids[i] = scheduler.add(&run<Body>, uint64_t(i), scheduler.getFutureResult<uint64_t>(ids[in[0]]));
+        } else {
+            ids[i] = scheduler.add(&run<Body>,
+                scheduler.getFutureResult<uint64_t>(ids[in[0]]), scheduler.getFutureResult<uint64_t>(ids[in[1]]));
+        }
+    }
+    auto added = std::chrono::steady_clock::now();
+    scheduler.executeAll();
+    auto executed = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double, std::nano> adding = added - start;
+    std::chrono::duration<double, std::nano> executing = executed - added;
+    return {adding.count(), executing.count(), scheduler.memoryUsage()};
+}
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+static std::vector<size_t> parseList(const char* text) {
+    std::vector<size_t> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(std::strtoul(item.c_str(), nullptr, 10));
+    }
+    return values;
+}
+
+static TOptions parseOptions(int argc, char* argv[]) {
+    TOptions options;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        } else if (std::strcmp(argv[i], "--tasks") == 0 && hasValue) {
+            options.tasks = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = parseList(argv[++i]);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && hasValue) {
+            options.repeat = std::max<size_t>(std::strtoul(argv[++i], nullptr, 10), 1);
+        } else {
+            std::cerr << "usage: scheduler_suite [--json] [--tasks N] [--threads 0,1,2,4] [--repeat R]" << std::endl;
+            std::exit(1);
+        }
+    }
+    return options;
+}
+
+class TReporter {
+public:
+    explicit TReporter(bool json) : json_(json) {
+        if (!json_) {
+            std::cout << "workload,body,threads,tasks,edges,depth,add_ns,exec_ns,tasks_per_s,makespan_ms,speedup,memory_bytes"
+                << std::endl;
+        }
+    }
+
+    void report(const TDagWorkload& dag, const char* body, size_t threads, double addNanos, double executeNanos,
+                double serialNanos, size_t memory) {
+        double tasks = double(dag.size());
+        double speedup = serialNanos > 0 ? serialNanos / executeNanos : 0.0;
+        if (json_) {
+            std::cout << "{\"workload\":\"" << dag.name << "\",\"body\":\"" << body << "\",\"threads\":" << threads
+                << ",\"tasks\":" << dag.size() << ",\"edges\":" << dag.edges() << ",\"depth\":" << dag.depth()
+                << ",\"add_ns\":" << addNanos / tasks << ",\"exec_ns\":" << executeNanos / tasks
+                << ",\"tasks_per_s\":" << tasks / executeNanos * 1e9 << ",\"makespan_ms\":" << executeNanos / 1e6
+                << ",\"speedup\":" << speedup << ",\"memory_bytes\":" << double(memory) / tasks << "}" << std::endl;
+        } else {
+            std::cout << dag.name << "," << body << "," << threads << "," << dag.size() << "," << dag.edges() << ","
+                << dag.depth() << "," << addNanos / tasks << "," << executeNanos / tasks << ","
+                << tasks / executeNanos * 1e9 << "," << executeNanos / 1e6 << "," << speedup << ","
+                << double(memory) / tasks << std::endl;
+        }
+    }
+
+private:
+    bool json_;
+};
+
+template<EBody Body>
+static void runCases(TReporter& reporter, const char* body, const TDagWorkload& dag, const TOptions& options) {
+    double serial = 0;
+    for (size_t threads : options.threads) {
+        std::vector<double> adds;
+        std::vector<double> executes;
+        size_t memory = 0;
+        for (size_t r = 0; r < options.repeat; ++r) {
+            TResult result = measure<Body>(dag, threads);
+            adds.push_back(result.addNanos);
+            executes.push_back(result.executeNanos);
+            memory = result.memory;
+        }
+        double execute = median(executes);
+        if (threads == 0) {
+            serial = execute;
+        }
+        reporter.report(dag, body, threads, median(adds), execute, serial, memory);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    TOptions options = parseOptions(argc, argv);
+    std::cout.setf(std::ios::fixed);
+    std::cout.precision(3);
+    TReporter reporter(options.json);
+
+    auto workloads = [](size_t tasks) {
+        return std::vector<TDagWorkload>{
+            independentTasks(tasks),
+            chain(tasks),
+            fanOutFanIn(tasks),
+            reductionTree(tasks),
+            randomLayered(tasks, 64, 1),
+        };
+    };
+    for (const TDagWorkload& dag : workloads(options.tasks)) {
+        runCases<EBody::Tiny>(reporter, "tiny", dag, options);
+    }
+    // Heavy graphs are kept small enough for each case to take well under a second.
+    for (const TDagWorkload& dag : workloads(std::max<size_t>(options.tasks / 100, 64))) {
+        runCases<EBody::Heavy>(reporter, "heavy", dag, options);
+    }
+    return 0;
+}
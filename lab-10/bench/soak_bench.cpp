@@ -0,0 +1,93 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <unistd.h>
+
+#include "lib/scheduler.h"
+
+// Memory of a long-running scheduler: batches of tasks with 1 KB vector results are
+// added, run and read over and over, one subgraph per batch is cancelled, and the
+// resident set size is printed as the task count grows. Without clear() memory grows
+// with every task; with it, and with results released once consumed, it stays flat.
+// Usage: soak_bench [million tasks] [threads]
+
+static double residentMegabytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    size_t resident = 0;
+    statm >> pages >> resident;
+    return double(resident) * double(sysconf(_SC_PAGESIZE)) / (1 << 20);
+}
+
+// Leaves make vectors, pairs of them are summed element-wise down to one vector.
+static size_t addBatch(TTaskScheduler& scheduler, size_t leaves, size_t seed) {
+    std::vector<size_t> level;
+    for (size_t i = 0; i < leaves; ++i) {
+        level.push_back(scheduler.add([](size_t value) { return std::vector<double>(128, double(value)); }, seed + i));
+    }
+    size_t cancelled = level[seed % leaves];
+    while (level.size() > 1) {
+        std::vector<size_t> next;
+        for (size_t i = 0; i + 1 < level.size(); i += 2) {
+            next.push_back(scheduler.add([](const std::vector<double>& a, const std::vector<double>& b) {
+                std::vector<double> sum(a.size());
+                for (size_t k = 0; k < a.size(); ++k) {
+                    sum[k] = a[k] + b[k];
+                }
+                return sum;
+            }, scheduler.getFutureResult<std::vector<double>>(level[i]), scheduler.getFutureResult<std::vector<double>>(level[i + 1])));
+        }
+        if (level.size() % 2 == 1) {
+            next.push_back(level.back());
+        }
+        level.swap(next);
+    }
+    // The last leaf's chain to the root also goes, so the root result is a TTaskCancelled.
+    scheduler.cancel(cancelled);
+    return level[0];
+}
+
+static void soak(const char* name, size_t tasks, size_t threads, bool bounded) {
+    const size_t leaves = 4096;
+    const size_t perBatch = 2 * leaves - 1;
+    const size_t batches = tasks / perBatch;
+    const size_t reports = 8;
+
+    TTaskScheduler scheduler(threads);
+    if (bounded) {
+        scheduler.setResultRelease(EResultRelease::WhenConsumed);
+    }
+    std::cout << name << ":" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    size_t failed = 0;
+    for (size_t batch = 0; batch < batches; ++batch) {
+        size_t root = addBatch(scheduler, leaves, batch);
+        scheduler.executeAll();
+        try {
+            scheduler.getResultRef<std::vector<double>>(root);
+        } catch (const TTaskCancelled&) {
+            ++failed;
+        }
+        if (bounded) {
+            scheduler.clear();
+        }
+        if ((batch + 1) % std::max<size_t>(batches / reports, 1) == 0) {
+            std::cout << "  " << (batch + 1) * perBatch << " tasks: " << residentMegabytes() << " MB resident" << std::endl;
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << elapsed.count() / double(batches * perBatch) << " ns per task, " << failed
+        << " cancelled roots" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    double millions = argc > 1 ? std::strtod(argv[1], nullptr) : 4;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2;
+    size_t tasks = size_t(millions * 1e6);
+
+    soak("release when consumed, clear between batches", tasks, threads, true);
+    // Every result stays alive, so this one is kept short.
+    soak("keep everything", std::min<size_t>(tasks, 500000), threads, false);
+    return 0;
+}
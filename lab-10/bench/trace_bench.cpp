@@ -0,0 +1,61 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+
+#include "lib/scheduler.h"
+
+// Cost of tracing on a wide reduction of small tasks: the same graph with tracing off
+// and on. The traced run is written to trace.json (open it in chrome://tracing or
+// ui.perfetto.dev) and summarized on stdout.
+// Usage: trace_bench [leaves] [threads] [repetitions]
+
+static void build(TTaskScheduler& scheduler, size_t leaves) {
+    std::vector<size_t> level;
+    for (size_t leaf = 0; leaf < leaves; ++leaf) {
+        level.push_back(scheduler.add([](size_t x) { return x * x % 7; }, leaf));
+    }
+    while (level.size() > 1) {
+        std::vector<size_t> next;
+        for (size_t j = 0; j + 1 < level.size(); j += 2) {
+            next.push_back(scheduler.add([](size_t x, size_t y) { return x + y; },
+                scheduler.getFutureResult<size_t>(level[j]), scheduler.getFutureResult<size_t>(level[j + 1])));
+        }
+        if (level.size() % 2 == 1) {
+            next.push_back(level.back());
+        }
+        level.swap(next);
+    }
+}
+
+static double run(size_t leaves, size_t threads, size_t repetitions, bool traced) {
+    double total = 0;
+    for (size_t i = 0; i < repetitions; ++i) {
+        TTaskScheduler scheduler(threads);
+        if (traced) {
+            scheduler.enableTracing();
+        }
+        build(scheduler, leaves);
+        auto start = std::chrono::steady_clock::now();
+        scheduler.executeAll();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        total += elapsed.count();
+
+        if (traced && i + 1 == repetitions) {
+            std::ofstream out("trace.json");
+            scheduler.tracer()->writeChromeTrace(out);
+            scheduler.tracer()->writeSummary(std::cout);
+        }
+    }
+    return total / double(repetitions * (2 * leaves - 1));
+}
+
+int main(int argc, char* argv[]) {
+    size_t leaves = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2;
+    size_t repetitions = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 20;
+
+    double off = run(leaves, threads, repetitions, false);
+    double on = run(leaves, threads, repetitions, true);
+    std::cout << "tracing off: " << off << " ns per task, on: " << on << " ns per task" << std::endl;
+    return 0;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Synthetic DAGs for the benchmarks. Tasks are listed in an order where every input
+// comes before the task that reads it, and have at most two inputs, so that they map
+// directly onto TTaskScheduler::add() with FutureResult arguments.
+struct TDagWorkload {
+    std::string name;
+    std::vector<std::vector<size_t>> inputs;
+
+    size_t size() const {
+        return inputs.size();
+    }
+
+    size_t edges() const {
+        size_t count = 0;
+        for (const std::vector<size_t>& in : inputs) {
+            count += in.size();
+        }
+        return count;
+    }
+
+    // Tasks on the longest path, the most that cannot run in parallel.
+    size_t depth() const {
+        std::vector<size_t> level(inputs.size(), 1);
+        size_t deepest = 0;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            for (size_t input : inputs[i]) {
+                level[i] = std::max(level[i], level[input] + 1);
+            }
+            deepest = std::max(deepest, level[i]);
+        }
+        return deepest;
+    }
+
+    size_t add(std::vector<size_t> in) {
+        inputs.push_back(std::move(in));
+        return inputs.size() - 1;
+    }
+
+    // Sums `level` pairwise down to one task and returns it.
+    size_t reduce(std::vector<size_t> level) {
+        while (level.size() > 1) {
+            std::vector<size_t> next;
+            for (size_t i = 0; i + 1 < level.size(); i += 2) {
+                next.push_back(add({level[i], level[i + 1]}));
+            }
+            if (level.size() % 2 == 1) {
+                next.push_back(level.back());
+            }
+            level.swap(next);
+        }
+        return level[0];
+    }
+};
+
+inline TDagWorkload independentTasks(size_t tasks) {
+    TDagWorkload dag{"independent"};
+    for (size_t i = 0; i < tasks; ++i) {
+        dag.add({});
+    }
+    return dag;
+}
+
+inline TDagWorkload chain(size_t tasks) {
+    TDagWorkload dag{"chain"};
+    dag.add({});
+    for (size_t i = 1; i < tasks; ++i) {
+        dag.add({i - 1});
+    }
+    return dag;
+}
+
+// One source read by `width` tasks, whose results are summed back to one.
+inline TDagWorkload fanOutFanIn(size_t tasks) {
+    TDagWorkload dag{"fan-out/fan-in"};
+    size_t source = dag.add({});
+    std::vector<size_t> middle;
+    for (size_t i = 0; i < std::max<size_t>(tasks / 2, 1); ++i) {
+        middle.push_back(dag.add({source}));
+    }
+    dag.reduce(middle);
+    return dag;
+}
+
+inline TDagWorkload reductionTree(size_t tasks) {
+    TDagWorkload dag{"reduction tree"};
+    std::vector<size_t> leaves;
+    for (size_t i = 0; i < std::max<size_t>(tasks / 2, 1); ++i) {
+        leaves.push_back(dag.add({}));
+    }
+    dag.reduce(leaves);
+    return dag;
+}
+
+// Layers of `width` tasks, each reading one or two random tasks of the layer before.
+inline TDagWorkload randomLayered(size_t tasks, size_t width, uint32_t seed) {
+    TDagWorkload dag{"random layered"};
+    std::mt19937 random(seed);
+    for (size_t i = 0; i < width; ++i) {
+        dag.add({});
+    }
+    while (dag.size() < tasks) {
+        size_t previous = dag.size() - width;
+        for (size_t i = 0; i < width; ++i) {
+            std::vector<size_t> in{previous + random() % width};
+            if (random() % 2 == 0) {
+                in.push_back(previous + random() % width);
+            }
+            dag.add(in);
+        }
+    }
+    return dag;
+}
@@ -1,4 +1,4 @@
-#include "../include/scheduler.h"
+#include "../lib/scheduler.h"
 
 int main() {
     float a = 1;
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <new>
+
+// Bump allocator for task payloads, dependency edges and results that do not fit
+// inline. Memory is released only when the arena is destroyed, or recycled all at once
+// by reset(); objects placed in it are destroyed by their owners.
+//
+// Small allocations bump an atomic offset in the current block, so concurrent callers
+// do not serialize; the mutex is taken only to install a new block or to allocate a
+// large or over-aligned object, which gets a block of its own. Blocks start small and
+// double up to blockSize, so a scheduler with a handful of tasks stays cheap to create.
+class TArena {
+public:
+    explicit TArena(size_t blockSize = 64 * 1024) : blockSize_(blockSize) {}
+
+    TArena(const TArena&) = delete;
+    TArena& operator=(const TArena&) = delete;
+
+    ~TArena() {
+        for (const TBlock& block : blocks_) {
+            ::operator delete(block.memory, std::align_val_t(block.alignment));
+        }
+        releaseDedicated();
+    }
+
+    void* allocate(size_t size, size_t alignment) {
+        if (alignment > kGrain || size > blockSize_ / 4) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return newBlock(dedicated_, size, alignment > kBlockAlignment ? alignment : kBlockAlignment).memory;
+        }
+        // Offsets are kept at multiples of kGrain, which covers every alignment up to it.
+        size_t rounded = (size + kGrain - 1) & ~(kGrain - 1);
+        while (true) {
+            TBlock* block = current_.load(std::memory_order_acquire);
+            if (block != nullptr) {
+                size_t offset = block->used.fetch_add(rounded, std::memory_order_relaxed);
+                if (offset + rounded <= block->size) {
+                    return block->memory + offset;
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (current_.load(std::memory_order_relaxed) != block) {
+                continue;
+            }
+            if (block != nullptr && block->next != nullptr) {
+                current_.store(block->next, std::memory_order_release);
+                continue;
+            }
+            size_t size = block == nullptr ? kFirstBlockSize : std::min(block->size * 2, blockSize_);
+            TBlock& fresh = newBlock(blocks_, std::max(size, rounded), kBlockAlignment);
+            if (block != nullptr) {
+                block->next = &fresh;
+            }
+            current_.store(&fresh, std::memory_order_release);
+        }
+    }
+
+    // Bytes obtained from the general heap so far.
+    size_t reserved() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t total = 0;
+        for (const TBlock& block : blocks_) {
+            total += block.size;
+        }
+        for (const TBlock& block : dedicated_) {
+            total += block.size;
+        }
+        return total;
+    }
+
+    // Makes all memory available again. Regular blocks are kept and refilled in order,
+    // so a workload that resets between batches stops allocating once it has seen its
+    // largest batch. Only valid when nothing placed in the arena is in use any more and
+    // nobody allocates concurrently.
+    void reset() {
+        releaseDedicated();
+        for (TBlock& block : blocks_) {
+            block.used.store(0, std::memory_order_relaxed);
+        }
+        current_.store(blocks_.empty() ? nullptr : &blocks_.front(), std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t kBlockAlignment = 64;
+    static constexpr size_t kFirstBlockSize = 1024;
+    static constexpr size_t kGrain = alignof(std::max_align_t);
+
+    struct TBlock {
+        TBlock(std::byte* memory, size_t size, size_t alignment) : memory(memory), size(size), alignment(alignment) {}
+
+        std::byte* memory;
+        size_t size;
+        size_t alignment;
+        std::atomic<size_t> used{0};
+        TBlock* next = nullptr;
+    };
+
+    static TBlock& newBlock(std::deque<TBlock>& blocks, size_t size, size_t alignment) {
+        auto* memory = static_cast<std::byte*>(::operator new(size, std::align_val_t(alignment)));
+        return blocks.emplace_back(memory, size, alignment);
+    }
+
+    void releaseDedicated() {
+        for (const TBlock& block : dedicated_) {
+            ::operator delete(block.memory, std::align_val_t(block.alignment));
+        }
+        dedicated_.clear();
+    }
+
+    std::mutex mutex_;
+    // Regular blocks, chained through next in the order they are filled, and blocks
+    // holding a single large or over-aligned object.
+    std::deque<TBlock> blocks_;
+    std::deque<TBlock> dedicated_;
+    std::atomic<TBlock*> current_{nullptr};
+    size_t blockSize_;
+};
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#include "arena.h"
+#include "result_slot.h"
+#include "thread_pool.h"
+
+// Everything a running task needs to report its outcome. Synchronous tasks only use
+// result and arena; a coroutine task keeps a copy in its promise and calls finish
+// once it has produced its value, possibly long after it was started.
+struct TTaskContext {
+    TResultSlot* result;
+    std::exception_ptr* error;
+    TArena* arena;
+    TWorkStealingPool* pool;
+    void (*finish)(void* scheduler, size_t id);
+    void* scheduler;
+    size_t id;
+};
+
+// A suspended coroutine waiting for something. It is resumed as a job on the pool it
+// belongs to, or right on the thread that completes the wait when there is no pool.
+struct TContinuation {
+    std::coroutine_handle<> handle;
+    TWorkStealingPool* pool = nullptr;
+    TContinuation* next = nullptr;
+
+    void schedule() {
+        if (pool != nullptr) {
+            pool->submit({&resumeJob, handle.address(), 0});
+        } else {
+            handle.resume();
+        }
+    }
+
+    static void resumeJob(void* address, size_t) {
+        std::coroutine_handle<>::from_address(address).resume();
+    }
+};
+
+// Lock-free list of continuations that is closed exactly once. push() after close()
+// fails, so the caller knows not to suspend; close() resumes everyone pushed before.
+class TContinuationList {
+public:
+    bool push(TContinuation* continuation) {
+        TContinuation* head = head_.load(std::memory_order_acquire);
+        do {
+            if (head == closed()) {
+                return false;
+            }
+            continuation->next = head;
+        } while (!head_.compare_exchange_weak(head, continuation, std::memory_order_acq_rel, std::memory_order_acquire));
+        return true;
+    }
+
+    void close() {
+        TContinuation* head = head_.exchange(closed(), std::memory_order_acq_rel);
+        while (head != nullptr && head != closed()) {
+            // The continuation lives in the coroutine frame, which may be gone once resumed.
+            TContinuation* next = head->next;
+            head->schedule();
+            head = next;
+        }
+    }
+
+    bool isClosed() const {
+        return head_.load(std::memory_order_acquire) == closed();
+    }
+
+    // Reopens a closed list; only valid while nobody is pushing.
+    void reopen() {
+        TContinuation* expected = closed();
+        head_.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+    }
+
+private:
+    static TContinuation* closed() {
+        return reinterpret_cast<TContinuation*>(alignof(TContinuation));
+    }
+
+    std::atomic<TContinuation*> head_{nullptr};
+};
+
+
+struct TPromiseBase {
+    std::suspend_always initial_suspend() noexcept {
+        return {};
+    }
+
+    // The frame frees itself before reporting completion: nothing refers to it any more
+    // and the scheduler may be woken up and destroyed right after finish().
+    struct TFinalAwaiter {
+        bool await_ready() noexcept {
+            return false;
+        }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            TTaskContext context = handle.promise().context;
+            handle.destroy();
+            context.finish(context.scheduler, context.id);
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    TFinalAwaiter final_suspend() noexcept {
+        return {};
+    }
+
+    void unhandled_exception() {
+        *context.error = std::current_exception();
+    }
+
+    TTaskContext context{};
+};
+
+template<typename T>
+class TTask;
+
+template<typename T>
+struct TPromise : TPromiseBase {
+    TTask<T> get_return_object();
+
+    template<typename Value>
+    void return_value(Value&& value) {
+        context.result->emplace<T>(*context.arena, [&value]() -> T { return std::forward<Value>(value); });
+    }
+};
+
+template<>
+struct TPromise<void> : TPromiseBase {
+    TTask<void> get_return_object();
+
+    void return_void() {}
+};
+
+// Return type of coroutine tasks. A function passed to TTaskScheduler::add() that
+// returns TTask<T> produces a T result, but may co_await FutureResult values and
+// TEvent objects in between; while it is suspended the worker thread runs other jobs.
+// The coroutine starts when the scheduler runs the task and owns itself from then on.
+template<typename T>
+class [[nodiscard]] TTask {
+public:
+    using promise_type = TPromise<T>;
+    using value_type = T;
+
+    explicit TTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    TTask(TTask&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    TTask(const TTask&) = delete;
+    TTask& operator=(const TTask&) = delete;
+
+    ~TTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    void start(const TTaskContext& context) {
+        std::coroutine_handle<promise_type> handle = std::exchange(handle_, nullptr);
+        handle.promise().context = context;
+        handle.resume();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template<typename T>
+TTask<T> TPromise<T>::get_return_object() {
+    return TTask<T>(std::coroutine_handle<TPromise<T>>::from_promise(*this));
+}
+
+inline TTask<void> TPromise<void>::get_return_object() {
+    return TTask<void>(std::coroutine_handle<TPromise<void>>::from_promise(*this));
+}
+
+template<typename T>
+struct IsTask : std::false_type {};
+
+template<typename T>
+struct IsTask<TTask<T>> : std::true_type {};
+
+// Pool that a coroutine resumes on: its scheduler's pool for tasks, none otherwise.
+template<typename Promise>
+TWorkStealingPool* resumePool(std::coroutine_handle<Promise> handle) {
+    if constexpr (std::is_base_of_v<TPromiseBase, Promise>) {
+        return handle.promise().context.pool;
+    } else {
+        return nullptr;
+    }
+}
+
+
+// Manual-reset event for I/O completions and similar signals from outside the
+// scheduler. set() may be called from any thread; coroutines awaiting the event are
+// resumed on their scheduler's pool.
+class TEvent {
+public:
+    TEvent() = default;
+    TEvent(const TEvent&) = delete;
+    TEvent& operator=(const TEvent&) = delete;
+
+    void set() {
+        waiters_.close();
+    }
+
+    bool isSet() const {
+        return waiters_.isClosed();
+    }
+
+    // Only valid while no coroutine is waiting.
+    void reset() {
+        waiters_.reopen();
+    }
+
+    struct TAwaiter {
+        bool await_ready() const {
+            return event.isSet();
+        }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) {
+            continuation.handle = handle;
+            continuation.pool = resumePool(handle);
+            return event.waiters_.push(&continuation);
+        }
+
+        void await_resume() const {}
+
+        TEvent& event;
+        TContinuation continuation{};
+    };
+
+    TAwaiter operator co_await() {
+        return TAwaiter{*this};
+    }
+
+private:
+    TContinuationList waiters_;
+};
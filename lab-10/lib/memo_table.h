@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+#include <utility>
+
+#include "arena.h"
+
+// Concurrent map from task keys to the ids of the tasks that compute them. Keys of any
+// type with operator== share one table: an entry remembers its key's type and compares
+// only against keys of the same type. The table is split into shards, each with its own
+// lock, chosen by hash bits, so that producers adding different keys rarely contend;
+// a shard is an open-addressing array, so a new key costs no allocation of its own.
+class TMemoTable {
+public:
+    struct TStats {
+        size_t hits;
+        size_t misses;
+
+        double hitRate() const {
+            return hits + misses == 0 ? 0.0 : double(hits) / double(hits + misses);
+        }
+    };
+
+    TMemoTable() = default;
+    TMemoTable(const TMemoTable&) = delete;
+    TMemoTable& operator=(const TMemoTable&) = delete;
+
+    ~TMemoTable() {
+        clear();
+    }
+
+    // Returns the task stored under key, or calls add() and stores the id it returns.
+    // add() runs under the shard lock, so equal keys never produce two tasks.
+    template<typename Key, typename Add>
+    size_t findOrAdd(TArena& arena, size_t hash, const Key& key, Add add) {
+        TShard& shard = shards_[hash % kShards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (2 * (shard.used + 1) > shard.slots.size()) {
+            grow(shard);
+        }
+        size_t mask = shard.slots.size() - 1;
+        size_t index = (hash / kShards) & mask;
+        for (; shard.slots[index].key != nullptr; index = (index + 1) & mask) {
+            const TEntry& entry = shard.slots[index];
+            if (entry.hash == hash && (entry.ops == &kOps<Key> || *entry.ops->type == typeid(Key)) &&
+                *static_cast<const Key*>(entry.key) == key) {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return entry.task;
+            }
+        }
+        size_t task = add();
+        void* stored = ::new (arena.allocate(sizeof(Key), alignof(Key))) Key(key);
+        shard.slots[index] = {hash, stored, &kOps<Key>, task};
+        ++shard.used;
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return task;
+    }
+
+    TStats stats() const {
+        return {hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed)};
+    }
+
+    // Destroys every key; their memory belongs to the arena they were placed in.
+    void clear() {
+        for (TShard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (TEntry& entry : shard.slots) {
+                if (entry.key != nullptr) {
+                    entry.ops->destroy(entry.key);
+                    entry = {};
+                }
+            }
+            shard.used = 0;
+        }
+        hits_.store(0, std::memory_order_relaxed);
+        misses_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t kShards = 16;
+
+    struct TOps {
+        const std::type_info* type;
+        void (*destroy)(void* key);
+    };
+
+    template<typename Key>
+    static constexpr TOps kOps = {&typeid(Key), [](void* key) { static_cast<Key*>(key)->~Key(); }};
+
+    struct TEntry {
+        size_t hash = 0;
+        void* key = nullptr;
+        const TOps* ops = nullptr;
+        size_t task = 0;
+    };
+
+    // Open addressing with linear probing, kept at most half full.
+    struct alignas(64) TShard {
+        std::mutex mutex;
+        std::vector<TEntry> slots;
+        size_t used = 0;
+    };
+
+    static void grow(TShard& shard) {
+        std::vector<TEntry> slots(std::max<size_t>(shard.slots.size() * 2, 16));
+        size_t mask = slots.size() - 1;
+        for (const TEntry& entry : shard.slots) {
+            if (entry.key != nullptr) {
+                size_t index = (entry.hash / kShards) & mask;
+                while (slots[index].key != nullptr) {
+                    index = (index + 1) & mask;
+                }
+                slots[index] = entry;
+            }
+        }
+        shard.slots.swap(slots);
+    }
+
+    TShard shards_[kShards];
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> misses_{0};
+};
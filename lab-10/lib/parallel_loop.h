@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "arena.h"
+#include "coroutine.h"
+#include "thread_pool.h"
+
+// Index range of a parallel loop. grain is how many indices a job runs between two
+// checks for idle workers: raise it for very cheap bodies, keep it at 1 for costly ones.
+struct TIndexRange {
+    size_t begin;
+    size_t end;
+    size_t grain = 64;
+};
+
+// One data-parallel task: map(i) for every i in the range, folded with combine, or
+// just body(i) when T is void. On a pool the range is split lazily: a job works through
+// its range grain indices at a time and, before each chunk, hands the upper half of
+// what is left to the pool as a new job, but only if the pool has nothing queued, i.e.
+// some worker may be idle. On a busy pool a loop thus costs about as much as a plain
+// for; on an idle one it spreads over the workers in a few halvings.
+//
+// Like a TTask it is started with its task's context and reports through it, so the
+// task finishes, and its dependents are released, when the last job does. Partial
+// results are combined in whatever order jobs finish, so combine must be associative
+// and commutative.
+template<typename T, typename Map, typename Combine>
+class TParallelLoop {
+    using Value = std::conditional_t<std::is_void_v<T>, bool, T>;
+
+public:
+    TParallelLoop(TIndexRange range, Value identity, Map map, Combine combine)
+        : range_(range), identity_(std::move(identity)), map_(std::move(map)), combine_(std::move(combine)) {
+        range_.grain = std::max<size_t>(range_.grain, 1);
+    }
+
+    void start(const TTaskContext& context) {
+        if (context.pool == nullptr || range_.end <= range_.begin + range_.grain) {
+            try {
+                Value value = identity_;
+                for (size_t i = range_.begin; i < range_.end; ++i) {
+                    accumulate(map_, combine_, value, i);
+                }
+                publish(context, std::move(value));
+            } catch (...) {
+                *context.error = std::current_exception();
+            }
+            context.finish(context.scheduler, context.id);
+            return;
+        }
+        auto* state = ::new (context.arena->allocate(sizeof(TState), alignof(TState)))
+            TState{context, range_.grain, identity_, std::move(map_), std::move(combine_)};
+        state->process(range_.begin, range_.end);
+    }
+
+private:
+    // Shared by all jobs of one run; lives in the scheduler's arena and is destroyed by
+    // the job that finishes last.
+    struct TState {
+        TTaskContext context;
+        size_t grain;
+        Value identity;
+        Map map;
+        Combine combine;
+        std::atomic<size_t> outstanding{1};
+        std::atomic<bool> failed{false};
+        std::mutex mutex;
+        std::optional<Value> value;
+        std::exception_ptr error;
+
+        struct TRange {
+            TState* state;
+            size_t begin;
+            size_t end;
+        };
+
+        static void rangeJob(void* range, size_t) {
+            auto* job = static_cast<TRange*>(range);
+            job->state->process(job->begin, job->end);
+        }
+
+        void process(size_t begin, size_t end) {
+            try {
+                Value partial = identity;
+                while (begin < end && !failed.load(std::memory_order_relaxed)) {
+                    if (end - begin > grain && context.pool->queued() == 0) {
+                        size_t middle = begin + (end - begin) / 2;
+                        // Counted before the job can run; uncounted if it never will.
+                        outstanding.fetch_add(1, std::memory_order_relaxed);
+                        try {
+                            auto* job = ::new (context.arena->allocate(sizeof(TRange), alignof(TRange))) TRange{this, middle, end};
+                            context.pool->submit({&rangeJob, job, 0});
+                        } catch (...) {
+                            outstanding.fetch_sub(1, std::memory_order_relaxed);
+                            throw;
+                        }
+                        end = middle;
+                        continue;
+                    }
+                    for (size_t stop = std::min(end, begin + grain); begin < stop; ++begin) {
+                        accumulate(map, combine, partial, begin);
+                    }
+                }
+                merge(std::move(partial));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed.store(true, std::memory_order_relaxed);
+            }
+            if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                complete();
+            }
+        }
+
+        void merge(Value partial) {
+            if constexpr (!std::is_void_v<T>) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (value) {
+                    *value = combine(std::move(*value), std::move(partial));
+                } else {
+                    value.emplace(std::move(partial));
+                }
+            }
+        }
+
+        // Runs on a pool worker, where an exception would end the program, so a result
+        // that cannot be published becomes the task's error.
+        void complete() {
+            TTaskContext done = context;
+            if (error) {
+                *done.error = error;
+            } else if constexpr (!std::is_void_v<T>) {
+                try {
+                    publish(done, std::move(value ? *value : identity));
+                } catch (...) {
+                    *done.error = std::current_exception();
+                }
+            }
+            this->~TState();
+            done.finish(done.scheduler, done.id);
+        }
+    };
+
+    static void accumulate(Map& map, Combine& combine, Value& value, size_t i) {
+        if constexpr (std::is_void_v<T>) {
+            map(i);
+        } else {
+            value = combine(std::move(value), map(i));
+        }
+    }
+
+    static void publish(const TTaskContext& context, Value value) {
+        if constexpr (!std::is_void_v<T>) {
+            context.result->emplace<T>(*context.arena, [&value] { return std::move(value); });
+        }
+    }
+
+    TIndexRange range_;
+    Value identity_;
+    Map map_;
+    Combine combine_;
+};
+
+template<typename T>
+struct IsParallelLoop : std::false_type {};
+
+template<typename T, typename Map, typename Combine>
+struct IsParallelLoop<TParallelLoop<T, Map, Combine>> : std::true_type {};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Shared max-heap of ready tasks, ordered by explicit priority, then by the length of
+// the longest path from the task to the end of the graph, then by insertion order.
+// Pool jobs pop from it instead of carrying a task id, so whichever worker frees up
+// next always takes the most urgent ready task, not the one nearest in its own deque.
+class TReadyQueue {
+public:
+    struct TEntry {
+        int32_t priority;
+        double rank;
+        size_t task;
+
+        bool operator<(const TEntry& other) const {
+            if (priority != other.priority) {
+                return priority < other.priority;
+            }
+            if (rank != other.rank) {
+                return rank < other.rank;
+            }
+            return task > other.task;
+        }
+    };
+
+    void push(const TEntry& entry) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        heap_.push_back(entry);
+        std::push_heap(heap_.begin(), heap_.end());
+    }
+
+    bool pop(size_t& task) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (heap_.empty()) {
+            return false;
+        }
+        std::pop_heap(heap_.begin(), heap_.end());
+        task = heap_.back().task;
+        heap_.pop_back();
+        return true;
+    }
+
+    void reserve(size_t size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        heap_.reserve(size);
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<TEntry> heap_;
+};
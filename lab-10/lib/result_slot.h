@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <typeinfo>
+#include <type_traits>
+#include <utility>
+
+#include "arena.h"
+
+// Holds one task result. Values up to kInlineSize bytes live inside the slot, larger
+// ones in the scheduler's arena. The value is constructed directly from the task's
+// return value, so results such as vectors or strings are never copied on the way in.
+class TResultSlot {
+public:
+    static constexpr size_t kInlineSize = 2 * sizeof(void*);
+
+    template<typename T>
+    static constexpr bool fitsInline = sizeof(T) <= kInlineSize && alignof(T) <= alignof(std::max_align_t);
+
+    TResultSlot() = default;
+    TResultSlot(const TResultSlot&) = delete;
+    TResultSlot& operator=(const TResultSlot&) = delete;
+
+    ~TResultSlot() {
+        reset();
+    }
+
+    template<typename T, typename Factory>
+    void emplace(TArena& arena, Factory&& make) {
+        void* where = fitsInline<T> ? static_cast<void*>(inline_) : arena.allocate(sizeof(T), alignof(T));
+        ::new (where) T(make());
+        value_ = where;
+        ops_ = &kOps<T>;
+    }
+
+    template<typename T>
+    T& get() {
+        if (value_ == nullptr || (ops_ != &kOps<T> && *ops_->type != typeid(T))) {
+            throw std::bad_cast();
+        }
+        return *std::launder(static_cast<T*>(value_));
+    }
+
+    bool hasValue() const {
+        return value_ != nullptr;
+    }
+
+    void reset() {
+        if (value_ != nullptr) {
+            ops_->destroy(value_);
+            value_ = nullptr;
+        }
+    }
+
+private:
+    struct TOps {
+        const std::type_info* type;
+        void (*destroy)(void* value);
+    };
+
+    template<typename T>
+    static constexpr TOps kOps = {&typeid(T), [](void* value) { static_cast<T*>(value)->~T(); }};
+
+    alignas(std::max_align_t) std::byte inline_[kInlineSize];
+    void* value_ = nullptr;
+    const TOps* ops_ = nullptr;
+};
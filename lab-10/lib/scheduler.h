@@ -2,21 +2,51 @@
 #include <memory>
 #include <iostream>
 #include <cmath>
+#include <atomic>
+#include <concepts>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <typeinfo>
+#include <variant>
 
+#include "arena.h"
+#include "coroutine.h"
+#include "memo_table.h"
+#include "parallel_loop.h"
+#include "ready_queue.h"
+#include "result_slot.h"
+#include "segmented_vector.h"
+#include "thread_pool.h"
+#include "trace.h"
+
+// Move-only type-erased task. The functor and its (decayed) arguments are stored
+// inline when they fit in kInlineSize bytes and are nothrow-movable, otherwise in the
+// scheduler's arena; either way creating a task does not touch the general heap.
+// Calling it returns false when the task is a coroutine that will finish later.
 class TypeAgnosticCallable {
 public:
-    struct Base {
-        virtual int8_t* call() = 0;
-    };
+    static constexpr size_t kInlineSize = 4 * sizeof(void*);
 
     template<typename Functor, typename... Args>
-    struct FunctionWrapper : public Base {
-        FunctionWrapper(const Functor& func, Args&&... args) : f(func), arguments(std::forward<Args>(args)...) {}
+    struct FunctionWrapper {
+        template<typename... Values>
+        FunctionWrapper(const Functor& func, Values&&... args) : f(func), arguments(std::forward<Values>(args)...) {}
 
-
-        int8_t* call() override {
-            auto tmp = callFunc(std::index_sequence_for<Args...>());
-            return reinterpret_cast<int8_t*&>(tmp);
+        bool call(const TTaskContext& context) {
+            using Result = decltype(callFunc(std::index_sequence_for<Args...>()));
+            if constexpr (IsTask<Result>::value || IsParallelLoop<Result>::value) {
+                callFunc(std::index_sequence_for<Args...>()).start(context);
+                return false;
+            } else if constexpr (std::is_void_v<Result>) {
+                callFunc(std::index_sequence_for<Args...>());
+            } else {
+                context.result->emplace<Result>(*context.arena, [this] { return callFunc(std::index_sequence_for<Args...>()); });
+            }
+            return true;
         }
 
         template<std::size_t... Indices>
@@ -28,73 +58,853 @@ public:
         std::tuple<Args...> arguments;
     };
 
+    TypeAgnosticCallable() = default;
+
+    template<typename Functor, typename... Args>
+    TypeAgnosticCallable(TArena& arena, const Functor& func, Args&&... args) {
+        emplace(arena, func, std::forward<Args>(args)...);
+    }
+
+    TypeAgnosticCallable(TypeAgnosticCallable&& other) noexcept {
+        moveFrom(other);
+    }
+
+    TypeAgnosticCallable& operator=(TypeAgnosticCallable&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~TypeAgnosticCallable() {
+        reset();
+    }
+
     template<typename Functor, typename... Args>
-    TypeAgnosticCallable(const Functor& func, Args&&... args) {
-        ptr_ = std::make_shared<FunctionWrapper<Functor, Args...>>(FunctionWrapper<Functor, Args...>(func, std::forward<Args>(args)...));
+    void emplace(TArena& arena, const Functor& func, Args&&... args) {
+        using Wrapper = FunctionWrapper<Functor, std::decay_t<Args>...>;
+        reset();
+        void* where = fitsInline<Wrapper> ? static_cast<void*>(inline_) : arena.allocate(sizeof(Wrapper), alignof(Wrapper));
+        object_ = ::new (where) Wrapper(func, std::forward<Args>(args)...);
+        vtable_ = &kVTable<Wrapper>;
     }
 
-    TypeAgnosticCallable(const TypeAgnosticCallable& other) {
-        ptr_ = other.ptr_;
+    bool operator()(const TTaskContext& context) {
+        return vtable_->call(object_, context);
     }
 
-    int8_t* operator()() const {
-        return ptr_->call();
+    explicit operator bool() const {
+        return vtable_ != nullptr;
+    }
+
+    // Destroys the payload; arena memory is reclaimed with the arena.
+    void reset() {
+        if (vtable_ != nullptr) {
+            vtable_->destroy(object_);
+            vtable_ = nullptr;
+            object_ = nullptr;
+        }
     }
 
 private:
-    std::shared_ptr<Base> ptr_;
+    struct TVTable {
+        bool (*call)(void* object, const TTaskContext& context);
+        void (*relocate)(void* from, void* to);
+        void (*destroy)(void* object);
+    };
+
+    template<typename Wrapper>
+    static constexpr bool fitsInline = sizeof(Wrapper) <= kInlineSize &&
+        alignof(Wrapper) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Wrapper>;
+
+    template<typename Wrapper>
+    static constexpr TVTable kVTable = {
+        [](void* object, const TTaskContext& context) { return static_cast<Wrapper*>(object)->call(context); },
+        [](void* from, void* to) {
+            ::new (to) Wrapper(std::move(*static_cast<Wrapper*>(from)));
+            static_cast<Wrapper*>(from)->~Wrapper();
+        },
+        [](void* object) { static_cast<Wrapper*>(object)->~Wrapper(); },
+    };
+
+    void moveFrom(TypeAgnosticCallable& other) {
+        if (other.vtable_ == nullptr) {
+            return;
+        }
+        if (other.object_ == other.inline_) {
+            other.vtable_->relocate(other.inline_, inline_);
+            object_ = inline_;
+        } else {
+            object_ = other.object_;
+        }
+        vtable_ = other.vtable_;
+        other.vtable_ = nullptr;
+        other.object_ = nullptr;
+    }
+
+    alignas(std::max_align_t) std::byte inline_[kInlineSize];
+    void* object_ = nullptr;
+    const TVTable* vtable_ = nullptr;
 };
 
 
+class TTaskScheduler;
+
 template <typename T>
 class FutureResult {
 public:
-    FutureResult(const TypeAgnosticCallable& func_, size_t id, std::vector<int8_t*>& results) : func(func_), id_(id), results_(results) {};
-    operator T() const {
-        if (results_[id_] == nullptr) {
-            results_[id_] = func();
-        }
-        return *reinterpret_cast<const T*>(&results_[id_]);
+    FutureResult(TTaskScheduler& scheduler, size_t id) : scheduler_(&scheduler), id_(id) {};
+    operator T() const;
+
+    // Inside a TTask coroutine: suspends until the result is ready instead of blocking.
+    auto operator co_await() const;
+
+    size_t id() const {
+        return id_;
     }
 private:
-    TypeAgnosticCallable func;
-    std::vector<int8_t*> mutable results_;
+    TTaskScheduler* scheduler_;
     size_t id_;
 };
 
+template<typename T>
+struct IsFutureResult : std::false_type {};
+
+template<typename T>
+struct IsFutureResult<FutureResult<T>> : std::true_type {
+    using Type = T;
+};
+
+
+// A task can be memoized when its callable has no state of its own (a function pointer
+// or a captureless lambda) and every argument is either a FutureResult or a value that
+// std::hash and operator== accept.
+template<typename T>
+concept MemoKeyPart = IsFutureResult<T>::value || requires(const T& value) {
+    { std::hash<T>{}(value) } -> std::convertible_to<size_t>;
+    { value == value } -> std::convertible_to<bool>;
+};
+
+template<typename Function, typename... Args>
+concept Memoizable = (std::is_empty_v<Function> || std::is_function_v<std::remove_pointer_t<Function>>) &&
+    (MemoKeyPart<Args> && ...);
+
+
+// How a thread that needs a result already being computed by another thread waits:
+// Spin yields in a loop, Block sleeps on the task's state, Help runs other pool jobs
+// until the result is ready (and blocks when the scheduler has no pool).
+enum class EWaitPolicy {
+    Spin,
+    Block,
+    Help,
+};
+
+// What happens to a result once the tasks that take it as a FutureResult have finished.
+// Keep holds every result until clear() or destruction. WhenConsumed destroys it, and
+// a task's payload as soon as the task finishes, so that only results still needed, and
+// those of tasks with no dependents, stay alive; keepResult() pins one explicitly.
+enum class EResultRelease {
+    Keep,
+    WhenConsumed,
+};
+
+// Thrown when reading the result of a task that cancel() stopped from running.
+class TTaskCancelled : public std::runtime_error {
+public:
+    explicit TTaskCancelled(size_t id) : std::runtime_error("task " + std::to_string(id) + " was cancelled") {}
+};
+
+// Order in which a parallel executeAll() starts ready tasks. Fifo hands each task to
+// the pool as soon as it is ready, which is the cheapest. Priority starts ready tasks
+// by setPriority() value; CriticalPath breaks ties by the longest chain of setCost()
+// weighted work still depending on the task, so long chains are not starved by
+// short independent tasks.
+enum class EDispatchOrder {
+    Fifo,
+    Priority,
+    CriticalPath,
+};
+
 
+// Tasks form a DAG: every FutureResult argument of add() is an edge from the task that
+// produces it. executeAll() runs tasks in insertion order on the calling thread, unless
+// the scheduler was created with worker threads; then every task whose inputs are ready
+// is handed to a work-stealing pool and its dependents are released as it finishes.
+//
+// add(), getResult() and FutureResult conversions may be called from any number of
+// threads at once, including from inside tasks. executeAll() runs the tasks added
+// before it was called and must not itself be called concurrently.
+//
+// A task may also be a coroutine returning TTask<T> (see coroutine.h). It can
+// co_await FutureResult values and TEvent signals without holding a thread; it is
+// resumed on the pool, or without one on the thread that completed what it awaited.
 class TTaskScheduler {
 public:
+    TTaskScheduler() = default;
+
+    explicit TTaskScheduler(size_t threads, EWaitPolicy waitPolicy = EWaitPolicy::Help) : waitPolicy_(waitPolicy) {
+        if (threads > 0) {
+            pool_ = std::make_unique<TWorkStealingPool>(threads);
+        }
+    }
+
     template<typename Function, typename... Args>
     size_t add(const Function& func, Args&&... args) {
-        results.resize(size + 1, nullptr);
-        TypeAgnosticCallable tmp(func, std::forward<Args>(args)...);
-        container.push_back(tmp);
-        return size++;
+        if constexpr (Memoizable<std::decay_t<Function>, std::decay_t<Args>...>) {
+            if (memoize_) {
+                TMemoKey<std::decay_t<Function>, std::decay_t<Args>...> key{memoFunction(func), {memoPart(args)...}};
+                return memo_.findOrAdd(arena_, key.hash(), key, [&] {
+                    size_t id = addTask(func, std::forward<Args>(args)...);
+                    keepResult(id);
+                    return id;
+                });
+            }
+        }
+        return addTask(func, std::forward<Args>(args)...);
+    }
+
+    // Makes add() return the id of an earlier task instead of adding a new one when both
+    // call the same memoizable callable (see Memoizable) with equal arguments; two
+    // FutureResult arguments are equal if they name the same task, so chains of such
+    // tasks coalesce as a whole. Tasks must be pure for this to be correct. Memoized
+    // results are never released by EResultRelease::WhenConsumed, only by clear().
+    void enableMemoization() {
+        memoize_ = true;
+    }
+
+    // Lookups and how many of them found an earlier task, since the last clear().
+    TMemoTable::TStats memoStats() const {
+        return memo_.stats();
+    }
+
+    // One task that calls body(i, args...) for every i in the range, split over the pool
+    // (see TParallelLoop). Its id can be awaited and depended on like any other task's;
+    // FutureResult arguments are read once, before the loop starts.
+    template<typename Body, typename... Args>
+    size_t addParallelFor(TIndexRange range, const Body& body, Args&&... args) {
+        return add([range, body](const auto&... args) {
+            auto map = [body, ...values = argumentValue(args)](size_t i) { body(i, values...); };
+            return TParallelLoop<void, decltype(map), bool>(range, false, std::move(map), false);
+        }, std::forward<Args>(args)...);
+    }
+
+    // One task whose result is combine() folded over map(i, args...) for every i in the
+    // range, starting from identity; combine must be associative and commutative.
+    template<typename T, typename Map, typename Combine, typename... Args>
+    size_t addParallelReduce(TIndexRange range, T identity, const Map& map, const Combine& combine, Args&&... args) {
+        return add([range, identity, map, combine](const auto&... args) {
+            auto element = [map, ...values = argumentValue(args)](size_t i) { return map(i, values...); };
+            return TParallelLoop<T, decltype(element), Combine>(range, identity, std::move(element), combine);
+        }, std::forward<Args>(args)...);
+    }
+
+    // Set before adding tasks: consumers are counted as tasks are added.
+    void setResultRelease(EResultRelease resultRelease) {
+        resultRelease_ = resultRelease;
+    }
+
+    // Keeps the result of `id` alive under EResultRelease::WhenConsumed, so that it can
+    // still be read after its dependents have finished.
+    void keepResult(size_t id) {
+        container[id].consumers.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Cancels `id` and every task that depends on it, directly or not, unless they have
+    // already started; returns how many were cancelled. Cancelled tasks count as
+    // finished, and reading their results throws TTaskCancelled. May be called at any
+    // time, also from inside a task.
+    size_t cancel(size_t id) {
+        size_t count = container.size();
+        std::vector<bool> visited(count);
+        std::vector<size_t> stack{id};
+        visited[id] = true;
+        size_t cancelled = 0;
+        while (!stack.empty()) {
+            size_t task = stack.back();
+            stack.pop_back();
+            TTaskNode& node = container[task];
+            waitAdded(node);
+            uint8_t expected = kPending;
+            if (node.state.compare_exchange_strong(expected, kRunning, std::memory_order_acq_rel)) {
+                node.cancelled = true;
+                node.error = std::make_exception_ptr(TTaskCancelled(task));
+                finish(task);
+                ++cancelled;
+            }
+            for (TEdge* edge = node.dependents.load(std::memory_order_acquire); edge != nullptr; edge = edge->next) {
+                if (edge->task < count && !visited[edge->task]) {
+                    visited[edge->task] = true;
+                    stack.push_back(edge->task);
+                }
+            }
+        }
+        return cancelled;
+    }
+
+    // Bytes the scheduler holds for task nodes, payloads, edges and results; memory that
+    // results own themselves, such as a vector's elements, is not included.
+    size_t memoryUsage() {
+        return container.capacity() * sizeof(TTaskNode) + arena_.reserved();
+    }
+
+    // Destroys every task and result and recycles their memory; ids start from 0 again.
+    // Must not overlap with any other call. A long-running user that adds, runs and reads
+    // batches of tasks and clears in between keeps memory bounded by its largest batch.
+    void clear() {
+        memo_.clear();
+        container.clear();
+        arena_.reset();
+        ranks_.clear();
+    }
+
+    void setWaitPolicy(EWaitPolicy waitPolicy) {
+        waitPolicy_ = waitPolicy;
+    }
+
+    void setDispatchOrder(EDispatchOrder dispatchOrder) {
+        dispatchOrder_ = dispatchOrder;
+    }
+
+    // Higher runs first among ready tasks; 0 by default. Used unless the order is Fifo.
+    void setPriority(size_t id, int32_t priority) {
+        container[id].priority = priority;
+    }
+
+    // Relative cost estimate for the critical path; 1 by default.
+    void setCost(size_t id, float cost) {
+        container[id].cost = cost;
+    }
+
+    // Starts recording task events, keeping the last eventsPerThread on every thread.
+    // Call before executeAll(); read the recorder only while nothing is running.
+    void enableTracing(size_t eventsPerThread = 1 << 16) {
+        tracer_ = std::make_unique<TTraceRecorder>(eventsPerThread);
+    }
+
+    // nullptr unless tracing is enabled.
+    const TTraceRecorder* tracer() const {
+        return tracer_.get();
     }
 
     template<typename T>
     T getResult(size_t id) {
-        if (results[id] == nullptr) {
-            results[id] = container[id]();
-        }
-        return *reinterpret_cast<const T*>(&results[id]);
+        return readyResult(id).get<T>();
+    }
+
+    // Reads a result in place, without copying it.
+    template<typename T>
+    const T& getResultRef(size_t id) {
+        return readyResult(id).get<T>();
+    }
+
+    // Moves a result out of the scheduler; later reads see the moved-from value.
+    template<typename T>
+    T takeResult(size_t id) {
+        return std::move(readyResult(id).get<T>());
     }
 
     template<typename T>
     FutureResult<T> getFutureResult(size_t id) {
-        return FutureResult<T>(container[id], id, results);
+        return FutureResult<T>(*this, id);
     }
 
+    // Behind `co_await FutureResult<T>`: a task nobody has started yet is run right
+    // here, as a blocking read would; otherwise the coroutine suspends until the task
+    // finishes and is resumed on the pool.
+    template<typename T>
+    struct TResultAwaiter {
+        bool await_ready() {
+            return scheduler.tryRun(id);
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            continuation.handle = handle;
+            continuation.pool = scheduler.pool_.get();
+            // Flagging the task first makes finish() close the list; if the task finished
+            // between the two steps, push() fails and the coroutine simply continues.
+            TTaskNode& node = scheduler.container[id];
+            if ((node.state.fetch_or(kAwaited, std::memory_order_acq_rel) & kStateMask) == kDone) {
+                return false;
+            }
+            return node.awaiters.push(&continuation);
+        }
+
+        T await_resume() {
+            return scheduler.getResult<T>(id);
+        }
+
+        TTaskScheduler& scheduler;
+        size_t id;
+        TContinuation continuation{};
+    };
+
     void executeAll() {
-        for (int i = 0; i < container.size(); ++i) {
-            if (results[i] == nullptr) {
-                results[i] = container[i]();
+        trace(TTraceRecorder::EKind::Begin, 0);
+        if (pool_) {
+            executeParallel();
+            return;
+        }
+        // Coroutine tasks that suspend are waited for only after every task has been
+        // started, since what they await may be a later task.
+        size_t count = container.size();
+        bool unfinished = false;
+        for (size_t i = 0; i < count; ++i) {
+            waitAdded(container[i]);
+            unfinished |= !tryRun(i);
+        }
+        for (size_t i = 0; unfinished && i < count; ++i) {
+            if (stateOf(container[i]) != kDone) {
+                runOrWait(i);
             }
         }
+        rethrowFirstError(count);
     }
+
 private:
-    std::vector<TypeAgnosticCallable> container;
-    std::vector<int8_t*> results;
-    size_t size = 0;
-};
\ No newline at end of file
+    // The low bits hold the task state; kWaited is set by threads sleeping on the task
+    // and kAwaited by suspended coroutines, so that the thread finishing it knows to wake
+    // them, kReleasing by a parallel job that found the task unfinished and left
+    // releasing its dependents to finish().
+    static constexpr uint8_t kAdding = 0;
+    static constexpr uint8_t kPending = 1;
+    static constexpr uint8_t kRunning = 2;
+    static constexpr uint8_t kDone = 3;
+    static constexpr uint8_t kStateMask = 3;
+    static constexpr uint8_t kWaited = 4;
+    static constexpr uint8_t kReleasing = 8;
+    static constexpr uint8_t kAwaited = 16;
+
+    // Arena-allocated, singly linked list of the tasks that consume a result.
+    struct TEdge {
+        size_t task;
+        TEdge* next;
+    };
+
+    struct TTaskNode {
+        TypeAgnosticCallable call;
+        TResultSlot result;
+        std::exception_ptr error;
+        std::atomic<TEdge*> dependents{nullptr};
+        TContinuationList awaiters;
+        std::atomic<uint32_t> pending{0};
+        std::atomic<uint8_t> state{kAdding};
+        // Tracked only under EResultRelease::WhenConsumed.
+        const size_t* inputs = nullptr;
+        uint32_t inputCount = 0;
+        std::atomic<uint32_t> consumers{0};
+        std::atomic<bool> released{false};
+        bool cancelled = false;
+        bool scheduled = false;
+        int32_t priority = 0;
+        float cost = 1.0f;
+    };
+
+    template<typename Arg>
+    static void collectDependency(size_t* dependencies, size_t& count, const Arg& arg) {
+        if constexpr (IsFutureResult<std::decay_t<Arg>>::value) {
+            dependencies[count++] = arg.id();
+        }
+    }
+
+    template<typename Function, typename... Args>
+    size_t addTask(const Function& func, Args&&... args) {
+        size_t dependencies[sizeof...(Args) + 1];
+        size_t dependencyCount = 0;
+        (collectDependency(dependencies, dependencyCount, args), ...);
+
+        size_t id = container.claim();
+        TTaskNode& node = container[id];
+        // Everything that may throw comes before the task is linked to its inputs. If it
+        // does, the node is published as a finished, cancelled task holding the error, so
+        // that nothing waits for it to be added, and add() rethrows.
+        size_t* inputs = nullptr;
+        TEdge* edges = nullptr;
+        try {
+            node.call.emplace(arena_, func, std::forward<Args>(args)...);
+            if (resultRelease_ == EResultRelease::WhenConsumed && dependencyCount > 0) {
+                inputs = static_cast<size_t*>(arena_.allocate(dependencyCount * sizeof(size_t), alignof(size_t)));
+            }
+            if (dependencyCount > 0) {
+                edges = static_cast<TEdge*>(arena_.allocate(dependencyCount * sizeof(TEdge), alignof(TEdge)));
+            }
+        } catch (...) {
+            node.call.reset();
+            node.cancelled = true;
+            node.error = std::current_exception();
+            node.state.store(kDone, std::memory_order_release);
+            throw;
+        }
+        if (inputs != nullptr) {
+            for (size_t i = 0; i < dependencyCount; ++i) {
+                inputs[i] = dependencies[i];
+                container[dependencies[i]].consumers.fetch_add(1, std::memory_order_relaxed);
+            }
+            node.inputs = inputs;
+            node.inputCount = static_cast<uint32_t>(dependencyCount);
+        }
+        for (size_t i = 0; i < dependencyCount; ++i) {
+            std::atomic<TEdge*>& head = container[dependencies[i]].dependents;
+            TEdge* edge = ::new (edges + i) TEdge{id, head.load(std::memory_order_relaxed)};
+            while (!head.compare_exchange_weak(edge->next, edge, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
+        node.state.store(kPending, std::memory_order_release);
+        return id;
+    }
+
+    // A memoizable task as a table key: the callable (nothing for a captureless lambda,
+    // whose type already says everything) and the arguments, with task ids standing in
+    // for FutureResult values.
+    template<typename Function, typename... Args>
+    struct TMemoKey {
+        using FunctionPart = std::conditional_t<std::is_empty_v<Function>, std::monostate, Function>;
+
+        FunctionPart function;
+        std::tuple<std::conditional_t<IsFutureResult<Args>::value, size_t, Args>...> arguments;
+
+        bool operator==(const TMemoKey&) const = default;
+
+        size_t hash() const {
+            size_t seed = typeid(TMemoKey).hash_code();
+            if constexpr (!std::is_empty_v<Function>) {
+                combineHash(seed, std::hash<Function>{}(function));
+            }
+            std::apply([&seed](const auto&... parts) {
+                (combineHash(seed, std::hash<std::decay_t<decltype(parts)>>{}(parts)), ...);
+            }, arguments);
+            return seed;
+        }
+
+        static void combineHash(size_t& seed, size_t value) {
+            seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+        }
+    };
+
+    template<typename Function>
+    static auto memoFunction(const Function& func) {
+        if constexpr (std::is_empty_v<std::decay_t<Function>>) {
+            return std::monostate{};
+        } else {
+            return static_cast<std::decay_t<Function>>(func);
+        }
+    }
+
+    template<typename Arg>
+    static auto memoPart(const Arg& arg) {
+        if constexpr (IsFutureResult<std::decay_t<Arg>>::value) {
+            return arg.id();
+        } else {
+            return arg;
+        }
+    }
+
+    template<typename Arg>
+    static auto argumentValue(const Arg& arg) {
+        if constexpr (IsFutureResult<Arg>::value) {
+            return static_cast<typename IsFutureResult<Arg>::Type>(arg);
+        } else {
+            return arg;
+        }
+    }
+
+    static uint8_t stateOf(const TTaskNode& node) {
+        return node.state.load(std::memory_order_acquire) & kStateMask;
+    }
+
+    // Waits for a concurrent add() that has claimed the node to finish filling it.
+    static void waitAdded(const TTaskNode& node) {
+        while (node.state.load(std::memory_order_acquire) == kAdding) {
+            std::this_thread::yield();
+        }
+    }
+
+    TResultSlot& readyResult(size_t id) {
+        TTaskNode& node = container[id];
+        if (stateOf(node) != kDone) {
+            runOrWait(id);
+        }
+        if (node.error) {
+            std::rethrow_exception(node.error);
+        }
+        if (node.released.load(std::memory_order_acquire)) {
+            throw std::logic_error("result of task " + std::to_string(id) + " was released after its dependents consumed it");
+        }
+        return node.result;
+    }
+
+    // Claims the task and runs it here, or waits for the thread that already claimed it;
+    // also waits for a coroutine task that suspended.
+    void runOrWait(size_t id) {
+        if (!tryRun(id)) {
+            waitDone(container[id]);
+        }
+    }
+
+    void waitDone(TTaskNode& node) {
+        if (waitPolicy_ == EWaitPolicy::Spin) {
+            while (stateOf(node) != kDone) {
+                std::this_thread::yield();
+            }
+            return;
+        }
+        uint8_t state = node.state.fetch_or(kWaited, std::memory_order_acq_rel) | kWaited;
+        if (waitPolicy_ == EWaitPolicy::Help && pool_) {
+            pool_->helpUntil([&node] { return stateOf(node) == kDone; });
+            return;
+        }
+        while ((state & kStateMask) != kDone) {
+            node.state.wait(state, std::memory_order_acquire);
+            state = node.state.load(std::memory_order_acquire);
+        }
+    }
+
+    // Starts the task if nobody has claimed it yet; true if it has finished.
+    bool tryRun(size_t id) {
+        TTaskNode& node = container[id];
+        uint8_t expected = kPending;
+        if (node.state.compare_exchange_strong(expected, kRunning, std::memory_order_acq_rel)) {
+            run(id);
+        }
+        return stateOf(node) == kDone;
+    }
+
+    void trace(TTraceRecorder::EKind kind, size_t id) {
+        if (tracer_) {
+            tracer_->record(kind, id);
+        }
+    }
+
+    void run(size_t id) {
+        trace(TTraceRecorder::EKind::Start, id);
+        TTaskNode& node = container[id];
+        TTaskContext context{&node.result, &node.error, &arena_, pool_.get(), &TTaskScheduler::finishTask, this, id};
+        bool finished = true;
+        try {
+            finished = node.call(context);
+        } catch (...) {
+            node.error = std::current_exception();
+        }
+        if (finished) {
+            finish(id);
+        }
+    }
+
+    // Called once per task, when its result or error is in place; for a coroutine task
+    // that is when the coroutine completes, on whichever thread resumed it last.
+    void finish(size_t id) {
+        trace(TTraceRecorder::EKind::Finish, id);
+        TTaskNode& node = container[id];
+        if (resultRelease_ == EResultRelease::WhenConsumed) {
+            node.call.reset();
+            for (uint32_t i = 0; i < node.inputCount; ++i) {
+                consume(node.inputs[i]);
+            }
+        }
+        // Every consumer may have finished, or been cancelled, before this task did. This
+        // store and load pair with the decrement and load in consume() and, being
+        // sequentially consistent, at least one side sees the other's write; with weaker
+        // orders both could read the old values and neither release the result.
+        uint8_t previous = node.state.exchange(kDone, std::memory_order_seq_cst);
+        if (resultRelease_ == EResultRelease::WhenConsumed && node.dependents.load(std::memory_order_acquire) != nullptr &&
+            node.consumers.load(std::memory_order_seq_cst) == 0) {
+            releaseResult(node);
+        }
+        if (previous & kWaited) {
+            node.state.notify_all();
+            if (pool_) {
+                pool_->notifyAll();
+            }
+        }
+        if (previous & kAwaited) {
+            node.awaiters.close();
+        }
+        if (previous & kReleasing) {
+            releaseDependents(id);
+        }
+    }
+
+    // Drops one use of the result of `id`; the last one destroys it if the task is done,
+    // otherwise finish() does. releaseResult() tolerates both doing it.
+    void consume(size_t id) {
+        TTaskNode& node = container[id];
+        if (node.consumers.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+            (node.state.load(std::memory_order_seq_cst) & kStateMask) == kDone) {
+            releaseResult(node);
+        }
+    }
+
+    static void releaseResult(TTaskNode& node) {
+        if (!node.released.exchange(true, std::memory_order_acq_rel)) {
+            node.result.reset();
+        }
+    }
+
+    static void finishTask(void* scheduler, size_t id) {
+        static_cast<TTaskScheduler*>(scheduler)->finish(id);
+    }
+
+    void executeParallel() {
+        size_t count = container.size();
+        std::atomic<size_t> remaining{0};
+        executing_ = count;
+        remaining_ = &remaining;
+
+        for (size_t i = 0; i < count; ++i) {
+            TTaskNode& node = container[i];
+            waitAdded(node);
+            node.scheduled = stateOf(node) != kDone;
+            node.pending.store(0, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (!container[i].scheduled) {
+                continue;
+            }
+            remaining.fetch_add(1, std::memory_order_relaxed);
+            for (TEdge* edge = container[i].dependents.load(std::memory_order_acquire); edge != nullptr; edge = edge->next) {
+                if (edge->task < count && container[edge->task].scheduled) {
+                    container[edge->task].pending.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        ranks_.clear();
+        if (dispatchOrder_ == EDispatchOrder::CriticalPath) {
+            computeRanks(count);
+        }
+
+        std::vector<size_t> ready;
+        for (size_t i = 0; i < count; ++i) {
+            if (container[i].scheduled && container[i].pending.load(std::memory_order_relaxed) == 0) {
+                ready.push_back(i);
+            }
+        }
+
+        // All initial tasks are queued before any job is submitted, so that the first
+        // worker to wake up already sees the most urgent one.
+        for (size_t id : ready) {
+            trace(TTraceRecorder::EKind::Ready, id);
+        }
+        if (dispatchOrder_ == EDispatchOrder::Fifo) {
+            for (size_t id : ready) {
+                pool_->submit({&TTaskScheduler::runJob, this, id});
+            }
+        } else {
+            for (size_t id : ready) {
+                ready_.push(readyEntry(id));
+            }
+            for (size_t i = 0; i < ready.size(); ++i) {
+                pool_->submit({&TTaskScheduler::runReadyJob, this, 0});
+            }
+        }
+        pool_->helpUntil([&remaining] { return remaining.load(std::memory_order_acquire) == 0; });
+        remaining_ = nullptr;
+        rethrowFirstError(count);
+    }
+
+    // Cancelled tasks hold TTaskCancelled, and tasks whose add() threw the error add()
+    // already rethrew; neither is reported again here.
+    void rethrowFirstError(size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (container[i].error && !container[i].cancelled) {
+                std::rethrow_exception(container[i].error);
+            }
+        }
+    }
+
+    // Never waits: if the task is suspended or running on another thread, releasing its
+    // dependents is left to finish(). Exactly one of the two sees the other's mark.
+    static void runJob(void* context, size_t id) {
+        TTaskScheduler& self = *static_cast<TTaskScheduler*>(context);
+        TTaskNode& node = self.container[id];
+
+        self.tryRun(id);
+        if ((node.state.fetch_or(kReleasing, std::memory_order_acq_rel) & kStateMask) == kDone) {
+            self.releaseDependents(id);
+        }
+    }
+
+    // Length of the costliest path from each scheduled task to the end of the graph.
+    // Dependents always have larger ids, so one backwards pass is enough.
+    void computeRanks(size_t count) {
+        ranks_.assign(count, 0.0);
+        for (size_t i = count; i-- > 0;) {
+            TTaskNode& node = container[i];
+            if (!node.scheduled) {
+                continue;
+            }
+            double longest = 0;
+            for (TEdge* edge = node.dependents.load(std::memory_order_acquire); edge != nullptr; edge = edge->next) {
+                if (edge->task < count) {
+                    longest = std::max(longest, ranks_[edge->task]);
+                }
+            }
+            ranks_[i] = node.cost + longest;
+        }
+    }
+
+    void dispatch(size_t id) {
+        trace(TTraceRecorder::EKind::Ready, id);
+        if (dispatchOrder_ == EDispatchOrder::Fifo) {
+            pool_->submit({&TTaskScheduler::runJob, this, id});
+            return;
+        }
+        ready_.push(readyEntry(id));
+        pool_->submit({&TTaskScheduler::runReadyJob, this, 0});
+    }
+
+    TReadyQueue::TEntry readyEntry(size_t id) {
+        return {container[id].priority, ranks_.empty() ? 0.0 : ranks_[id], id};
+    }
+
+    // One job is submitted per ready task, so the queue is never empty here.
+    static void runReadyJob(void* context, size_t) {
+        TTaskScheduler& self = *static_cast<TTaskScheduler*>(context);
+        size_t id;
+        if (self.ready_.pop(id)) {
+            runJob(context, id);
+        }
+    }
+
+    void releaseDependents(size_t id) {
+        for (TEdge* edge = container[id].dependents.load(std::memory_order_acquire); edge != nullptr; edge = edge->next) {
+            if (edge->task >= executing_) {
+                continue;
+            }
+            TTaskNode& dependent = container[edge->task];
+            if (dependent.scheduled && dependent.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                dispatch(edge->task);
+            }
+        }
+        // executeAll() may return as soon as the count reaches zero.
+        TWorkStealingPool* pool = pool_.get();
+        if (remaining_->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pool->notifyAll();
+        }
+    }
+
+    TArena arena_;
+    TSegmentedVector<TTaskNode, 4> container;
+    TMemoTable memo_;
+    std::unique_ptr<TWorkStealingPool> pool_;
+    EWaitPolicy waitPolicy_ = EWaitPolicy::Block;
+    EDispatchOrder dispatchOrder_ = EDispatchOrder::Fifo;
+    EResultRelease resultRelease_ = EResultRelease::Keep;
+    bool memoize_ = false;
+    TReadyQueue ready_;
+    std::vector<double> ranks_;
+    std::unique_ptr<TTraceRecorder> tracer_;
+    size_t executing_ = 0;
+    std::atomic<size_t>* remaining_ = nullptr;
+};
+
+
+template<typename T>
+FutureResult<T>::operator T() const {
+    return scheduler_->getResult<T>(id_);
+}
+
+template<typename T>
+auto FutureResult<T>::operator co_await() const {
+    return TTaskScheduler::TResultAwaiter<T>{*scheduler_, id_};
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+// Append-only vector made of segments that double in size: segment k holds
+// kFirstSegment << k elements. Elements never move once created, so references stay
+// valid while the vector grows, and a million elements take about ten allocations.
+//
+// claim() may be called from several threads at once: the index comes from a single
+// fetch_add and the first thread to need a segment installs it with a compare-exchange,
+// so producers take no lock and wait only while a new segment is being built. Elements
+// are default-constructed together with their segment; publishing the filled element
+// to other threads is up to the caller.
+template<typename T, size_t FirstSegmentBits = 10>
+class TSegmentedVector {
+public:
+    TSegmentedVector() = default;
+    TSegmentedVector(const TSegmentedVector&) = delete;
+    TSegmentedVector& operator=(const TSegmentedVector&) = delete;
+
+    ~TSegmentedVector() {
+        for (std::atomic<T*>& segment : segments_) {
+            if (segment.load(std::memory_order_relaxed) != installing()) {
+                delete[] segment.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Reserves the next element and returns its index.
+    size_t claim() {
+        size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        segment(locateSegment(index));
+        return index;
+    }
+
+    T& emplace_back() {
+        return (*this)[claim()];
+    }
+
+    // Valid for any index below size(), even if the thread that claimed it has not
+    // installed the segment yet.
+    T& operator[](size_t index) {
+        size_t k = locateSegment(index);
+        return segment(k)[index + kFirstSegment - (kFirstSegment << k)];
+    }
+
+    // Replaces every claimed element with a default-constructed one and starts over from
+    // index 0, keeping the segments for reuse. Not safe against concurrent calls.
+    void clear() {
+        size_t size = size_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < size; ++i) {
+            T* element = &(*this)[i];
+            std::destroy_at(element);
+            std::construct_at(element);
+        }
+        size_.store(0, std::memory_order_relaxed);
+    }
+
+    // Number of claimed elements; some of them may still be being filled.
+    size_t size() const {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    // Elements in the segments allocated so far.
+    size_t capacity() const {
+        size_t total = 0;
+        for (size_t k = 0; k < kSegments; ++k) {
+            T* segment = segments_[k].load(std::memory_order_acquire);
+            if (segment != nullptr && segment != installing()) {
+                total += kFirstSegment << k;
+            }
+        }
+        return total;
+    }
+
+private:
+    static constexpr size_t kFirstSegment = size_t(1) << FirstSegmentBits;
+    static constexpr size_t kSegments = sizeof(size_t) * 8 - FirstSegmentBits;
+
+    static size_t locateSegment(size_t index) {
+        return std::bit_width(index + kFirstSegment) - 1 - FirstSegmentBits;
+    }
+
+    T* segment(size_t k) {
+        T* current = segments_[k].load(std::memory_order_acquire);
+        if (current != nullptr && current != installing()) {
+            return current;
+        }
+        if (current == nullptr && segments_[k].compare_exchange_strong(current, installing(), std::memory_order_acq_rel)) {
+            T* fresh;
+            try {
+                fresh = new T[kFirstSegment << k]();
+            } catch (...) {
+                segments_[k].store(nullptr, std::memory_order_release);
+                throw;
+            }
+            segments_[k].store(fresh, std::memory_order_release);
+            return fresh;
+        }
+        // Another thread is constructing this segment; building a second copy of a
+        // large segment only to throw it away costs far more than waiting.
+        while ((current = segments_[k].load(std::memory_order_acquire)) == installing()) {
+            std::this_thread::yield();
+        }
+        return current;
+    }
+
+    static T* installing() {
+        return reinterpret_cast<T*>(alignof(T));
+    }
+
+    std::atomic<T*> segments_[kSegments] = {};
+    std::atomic<size_t> size_{0};
+};
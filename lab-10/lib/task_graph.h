@@ -0,0 +1,390 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+#include "coroutine.h"
+#include "thread_pool.h"
+
+// Typed reference to a value inside a task graph: either an input set before each run
+// or the result of an earlier task. Passing one to TTaskGraph::add() makes it a
+// dependency, the way FutureResult does for TTaskScheduler.
+template<typename T>
+class TGraphValue {
+public:
+    static constexpr size_t kInput = SIZE_MAX;
+
+    TGraphValue(size_t offset, size_t producer) : offset_(offset), producer_(producer) {}
+
+    size_t offset() const {
+        return offset_;
+    }
+
+    // Index of the task computing the value, or kInput.
+    size_t producer() const {
+        return producer_;
+    }
+
+private:
+    size_t offset_;
+    size_t producer_;
+};
+
+template<typename T>
+struct IsGraphValue : std::false_type {};
+
+template<typename T>
+struct IsGraphValue<TGraphValue<T>> : std::true_type {};
+
+
+// A DAG of tasks recorded once and replayed many times with new inputs. add() has the
+// same shape as TTaskScheduler::add(), but the argument types are resolved while
+// recording: every input and result gets a fixed, typed place in one buffer, and each
+// task reads its arguments straight from there. freeze() lays out the buffer and the
+// schedule (insertion order, which is topological, plus successor lists and
+// dependency counts for parallel runs); a run is then a loop over function pointers
+// with no allocation, type erasure of arguments or dependency bookkeeping.
+//
+//     TTaskGraph graph;
+//     auto a = graph.input<float>();
+//     auto id = graph.add([](float a) { return a * a; }, a);
+//     graph.setInput(a, 3.0f);
+//     graph.run();
+//     graph.getResult<float>(id);  // 9
+class TTaskGraph {
+public:
+    TTaskGraph() = default;
+    TTaskGraph(const TTaskGraph&) = delete;
+    TTaskGraph& operator=(const TTaskGraph&) = delete;
+
+    ~TTaskGraph() {
+        if (buffer_) {
+            for (const TSlot& slot : slots_) {
+                slot.ops->destroy(buffer_.get() + slot.offset);
+            }
+        }
+        for (const TStep& step : steps_) {
+            step.destroy(step.object);
+        }
+    }
+
+    template<typename T>
+    TGraphValue<T> input() {
+        checkRecording();
+        size_t offset = addSlot<T>();
+        inputs_.push_back(slots_.size() - 1);
+        return TGraphValue<T>(offset, TGraphValue<T>::kInput);
+    }
+
+    template<typename Function, typename... Args>
+    size_t add(const Function& func, Args&&... args) {
+        using Step = TStep::Wrapper<Function, std::decay_t<Args>...>;
+        using Result = typename Step::Result;
+        static_assert(!IsTask<Result>::value, "coroutine tasks cannot be recorded in a task graph");
+        checkRecording();
+
+        size_t id = steps_.size();
+        size_t resultOffset = 0;
+        if constexpr (!std::is_void_v<Result>) {
+            resultOffset = addSlot<Result>();
+        }
+        results_.push_back(std::is_void_v<Result> ? kNoSlot : slots_.size() - 1);
+
+        size_t firstDependency = dependencies_.size();
+        (collectDependency(args), ...);
+        dependencyBegin_.push_back(firstDependency);
+
+        void* memory = arena_.allocate(sizeof(Step), alignof(Step));
+        Step* step = ::new (memory) Step(func, resultOffset, std::forward<Args>(args)...);
+        steps_.push_back({&Step::run, [](void* object) { static_cast<Step*>(object)->~Step(); }, step});
+        return id;
+    }
+
+    template<typename T>
+    TGraphValue<T> getFutureResult(size_t id) {
+        return TGraphValue<T>(checkedSlot<T>(resultSlot(id)).offset, id);
+    }
+
+    template<typename T, typename Value>
+    void setInput(const TGraphValue<T>& input, Value&& value) {
+        freeze();
+        storage<T>(input.offset()).emplace(std::forward<Value>(value));
+    }
+
+    template<typename T>
+    const T& getResultRef(size_t id) {
+        const TSlot& slot = checkedSlot<T>(resultSlot(id));
+        std::optional<T>& value = storage<T>(slot.offset);
+        if (!value) {
+            throw std::logic_error("task graph has not been run");
+        }
+        return *value;
+    }
+
+    template<typename T>
+    T getResult(size_t id) {
+        return getResultRef<T>(id);
+    }
+
+    size_t size() const {
+        return steps_.size();
+    }
+
+    // Ends recording: allocates the value buffer and precomputes the schedule.
+    // Called by the first setInput() or run() if not called explicitly.
+    void freeze() {
+        if (buffer_) {
+            return;
+        }
+        buffer_.reset(static_cast<std::byte*>(::operator new(bufferSize_ ? bufferSize_ : 1, std::align_val_t(kBufferAlignment))));
+        for (const TSlot& slot : slots_) {
+            slot.ops->construct(buffer_.get() + slot.offset);
+        }
+
+        size_t count = steps_.size();
+        dependencyBegin_.push_back(dependencies_.size());
+        initialPending_.assign(count, 0);
+        successorBegin_.assign(count + 1, 0);
+        for (size_t i = 0; i < count; ++i) {
+            initialPending_[i] = static_cast<uint32_t>(dependencyBegin_[i + 1] - dependencyBegin_[i]);
+            for (size_t d = dependencyBegin_[i]; d < dependencyBegin_[i + 1]; ++d) {
+                ++successorBegin_[dependencies_[d] + 1];
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            successorBegin_[i + 1] += successorBegin_[i];
+        }
+        successors_.resize(dependencies_.size());
+        std::vector<size_t> filled(successorBegin_.begin(), successorBegin_.end() - 1);
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t d = dependencyBegin_[i]; d < dependencyBegin_[i + 1]; ++d) {
+                successors_[filled[dependencies_[d]]++] = static_cast<uint32_t>(i);
+            }
+            if (initialPending_[i] == 0) {
+                roots_.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        pending_ = std::make_unique<std::atomic<uint32_t>[]>(count);
+    }
+
+    // Runs every task on the calling thread in recording order. An exception thrown by
+    // a task stops the run and propagates; later tasks keep their previous results.
+    void run() {
+        prepareRun();
+        std::byte* buffer = buffer_.get();
+        for (const TStep& step : steps_) {
+            step.run(step.object, buffer);
+        }
+    }
+
+    // Runs the graph on a pool: roots are submitted first and every task is released by
+    // its last dependency, using the precomputed counts. After a task throws, the tasks
+    // not yet started are skipped and the first exception is rethrown here.
+    void run(TWorkStealingPool& pool) {
+        prepareRun();
+        size_t count = steps_.size();
+        for (size_t i = 0; i < count; ++i) {
+            pending_[i].store(initialPending_[i], std::memory_order_relaxed);
+        }
+        remaining_.store(count, std::memory_order_relaxed);
+        failed_.store(false, std::memory_order_relaxed);
+        pool_ = &pool;
+
+        for (uint32_t root : roots_) {
+            pool.submit({&TTaskGraph::stepJob, this, root});
+        }
+        pool.helpUntil([this] { return remaining_.load(std::memory_order_acquire) == 0; });
+        pool_ = nullptr;
+
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+private:
+    static constexpr size_t kNoSlot = SIZE_MAX;
+    static constexpr size_t kBufferAlignment = 64;
+
+    struct TSlotOps {
+        const std::type_info* type;
+        void (*construct)(void* place);
+        void (*destroy)(void* place);
+        bool (*engaged)(const void* place);
+    };
+
+    template<typename T>
+    static constexpr TSlotOps kSlotOps = {
+        &typeid(T),
+        [](void* place) { ::new (place) std::optional<T>(); },
+        [](void* place) { std::launder(static_cast<std::optional<T>*>(place))->~optional(); },
+        [](const void* place) { return std::launder(static_cast<const std::optional<T>*>(place))->has_value(); },
+    };
+
+    struct TSlot {
+        size_t offset;
+        const TSlotOps* ops;
+    };
+
+    struct TStep {
+        template<typename Functor, typename... Args>
+        struct Wrapper {
+            template<typename Value>
+            static const auto& resolve(const TGraphValue<Value>& value, std::byte* buffer) {
+                return **std::launder(reinterpret_cast<std::optional<Value>*>(buffer + value.offset()));
+            }
+
+            template<typename Value>
+                requires (!IsGraphValue<std::remove_const_t<Value>>::value)
+            static Value& resolve(Value& value, std::byte*) {
+                return value;
+            }
+
+            using Result = std::invoke_result_t<Functor&, decltype(resolve(std::declval<Args&>(), nullptr))...>;
+
+            template<typename... Values>
+            Wrapper(const Functor& func, size_t resultOffset, Values&&... args)
+                : f(func), resultOffset(resultOffset), arguments(std::forward<Values>(args)...) {}
+
+            static void run(void* object, std::byte* buffer) {
+                Wrapper& self = *static_cast<Wrapper*>(object);
+                if constexpr (std::is_void_v<Result>) {
+                    self.call(buffer, std::index_sequence_for<Args...>());
+                } else {
+                    std::launder(reinterpret_cast<std::optional<Result>*>(buffer + self.resultOffset))
+                        ->emplace(self.call(buffer, std::index_sequence_for<Args...>()));
+                }
+            }
+
+            template<std::size_t... Indices>
+            Result call(std::byte* buffer, std::index_sequence<Indices...>) {
+                return f(resolve(std::get<Indices>(arguments), buffer)...);
+            }
+
+            Functor f;
+            size_t resultOffset;
+            std::tuple<Args...> arguments;
+        };
+
+        void (*run)(void* object, std::byte* buffer);
+        void (*destroy)(void* object);
+        void* object;
+    };
+
+    struct TBufferDeleter {
+        void operator()(std::byte* buffer) const {
+            ::operator delete(buffer, std::align_val_t(kBufferAlignment));
+        }
+    };
+
+    template<typename T>
+    size_t addSlot() {
+        static_assert(alignof(std::optional<T>) <= kBufferAlignment, "over-aligned task graph values are not supported");
+        size_t alignment = alignof(std::optional<T>);
+        size_t offset = (bufferSize_ + alignment - 1) / alignment * alignment;
+        bufferSize_ = offset + sizeof(std::optional<T>);
+        slots_.push_back({offset, &kSlotOps<T>});
+        return offset;
+    }
+
+    template<typename T>
+    std::optional<T>& storage(size_t offset) {
+        return *std::launder(reinterpret_cast<std::optional<T>*>(buffer_.get() + offset));
+    }
+
+    template<typename T>
+    const TSlot& checkedSlot(size_t slot) const {
+        if (slot >= slots_.size() || *slots_[slot].ops->type != typeid(T)) {
+            throw std::bad_cast();
+        }
+        return slots_[slot];
+    }
+
+    size_t resultSlot(size_t id) const {
+        if (id >= results_.size()) {
+            throw std::out_of_range("no such task in the graph");
+        }
+        return results_[id];
+    }
+
+    template<typename Arg>
+    void collectDependency(const Arg& arg) {
+        if constexpr (IsGraphValue<std::decay_t<Arg>>::value) {
+            if (arg.producer() != std::decay_t<Arg>::kInput) {
+                dependencies_.push_back(arg.producer());
+            }
+        }
+    }
+
+    void checkRecording() const {
+        if (buffer_) {
+            throw std::logic_error("task graph is frozen");
+        }
+    }
+
+    void prepareRun() {
+        freeze();
+        for (size_t input : inputs_) {
+            if (!slots_[input].ops->engaged(buffer_.get() + slots_[input].offset)) {
+                throw std::logic_error("task graph input is not set");
+            }
+        }
+    }
+
+    static void stepJob(void* context, size_t index) {
+        TTaskGraph& self = *static_cast<TTaskGraph*>(context);
+        if (!self.failed_.load(std::memory_order_acquire)) {
+            const TStep& step = self.steps_[index];
+            try {
+                step.run(step.object, self.buffer_.get());
+            } catch (...) {
+                if (!self.failed_.exchange(true, std::memory_order_acq_rel)) {
+                    self.error_ = std::current_exception();
+                }
+            }
+        }
+        for (size_t s = self.successorBegin_[index]; s < self.successorBegin_[index + 1]; ++s) {
+            uint32_t successor = self.successors_[s];
+            if (self.pending_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                self.pool_->submit({&TTaskGraph::stepJob, &self, successor});
+            }
+        }
+        // The run may return, and the graph go away, as soon as remaining_ reaches zero.
+        TWorkStealingPool* pool = self.pool_;
+        if (self.remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pool->notifyAll();
+        }
+    }
+
+    TArena arena_;
+    std::vector<TStep> steps_;
+    std::vector<TSlot> slots_;
+    std::vector<size_t> inputs_;
+    std::vector<size_t> results_;
+    std::vector<size_t> dependencies_;
+    std::vector<size_t> dependencyBegin_;
+    size_t bufferSize_ = 0;
+
+    std::unique_ptr<std::byte, TBufferDeleter> buffer_;
+    std::vector<uint32_t> initialPending_;
+    std::vector<size_t> successorBegin_;
+    std::vector<uint32_t> successors_;
+    std::vector<uint32_t> roots_;
+    std::unique_ptr<std::atomic<uint32_t>[]> pending_;
+
+    TWorkStealingPool* pool_ = nullptr;
+    std::atomic<size_t> remaining_{0};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;
+};
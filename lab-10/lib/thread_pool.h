@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool. Every worker owns a deque: it pushes and pops its own jobs at
+// the back (LIFO keeps freshly readied dependents hot in cache) while idle workers
+// steal from the front of other deques. Jobs are plain function pointers plus two
+// words of context, so scheduling one never allocates.
+class TWorkStealingPool {
+public:
+    struct TJob {
+        void (*run)(void* context, size_t arg);
+        void* context;
+        size_t arg;
+    };
+
+    explicit TWorkStealingPool(size_t threads) {
+        if (threads == 0) {
+            threads = 1;
+        }
+        // One extra queue is shared by threads that are not workers of this pool.
+        for (size_t i = 0; i <= threads; ++i) {
+            queues_.push_back(std::make_unique<TQueue>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    TWorkStealingPool(const TWorkStealingPool&) = delete;
+    TWorkStealingPool& operator=(const TWorkStealingPool&) = delete;
+
+    ~TWorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t size() const {
+        return workers_.size();
+    }
+
+    void submit(const TJob& job) {
+        TQueue& queue = *queues_[currentQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(job);
+        }
+        queued_.fetch_add(1);
+        if (sleepers_.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            wake_.notify_one();
+        }
+    }
+
+    // Runs pool jobs on the calling thread until done() holds. Whoever makes done()
+    // true must call notifyAll() so that a helper parked on an empty pool wakes up.
+    template<typename Predicate>
+    void helpUntil(Predicate done) {
+        size_t home = currentQueue();
+        while (!done()) {
+            TJob job;
+            if (tryTake(home, job)) {
+                job.run(job.context, job.arg);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            sleepers_.fetch_add(1);
+            wake_.wait(lock, [&] { return queued_.load() > 0 || done(); });
+            sleepers_.fetch_sub(1);
+        }
+    }
+
+    void notifyAll() {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        wake_.notify_all();
+    }
+
+    // Jobs submitted and not yet taken; zero means a worker may be looking for work.
+    size_t queued() const {
+        return queued_.load(std::memory_order_relaxed);
+    }
+
+    bool isWorkerThread() const {
+        return currentPool_ == this;
+    }
+
+private:
+    struct TQueue {
+        std::mutex mutex;
+        std::deque<TJob> jobs;
+    };
+
+    size_t currentQueue() const {
+        return currentPool_ == this ? currentIndex_ : workers_.size();
+    }
+
+    bool tryTake(size_t home, TJob& job) {
+        if (queued_.load() == 0) {
+            return false;
+        }
+        {
+            TQueue& own = *queues_[home];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.jobs.empty()) {
+                job = own.jobs.back();
+                own.jobs.pop_back();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            TQueue& victim = *queues_[(home + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                job = victim.jobs.front();
+                victim.jobs.pop_front();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index) {
+        currentPool_ = this;
+        currentIndex_ = index;
+        while (true) {
+            TJob job;
+            if (tryTake(index, job)) {
+                job.run(job.context, job.arg);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            sleepers_.fetch_add(1);
+            wake_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+            sleepers_.fetch_sub(1);
+            if (stop_ && queued_.load() == 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<TQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> sleepers_{0};
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+
+    static inline thread_local const TWorkStealingPool* currentPool_ = nullptr;
+    static inline thread_local size_t currentIndex_ = 0;
+};
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Records what a scheduler did: when each task became ready, started and finished,
+// and on which thread. Every thread writes into its own fixed-size ring buffer, so
+// recording is a clock read and three stores with no shared writes; when a ring wraps,
+// the oldest events are overwritten and counted as dropped. Reading (the exports
+// below) must not overlap with execution.
+class TTraceRecorder {
+public:
+    enum class EKind : uint8_t {
+        Begin,   // executeAll() started; task is unused
+        Ready,   // all dependencies done, handed to the pool
+        Start,
+        Finish,
+    };
+
+    struct TEvent {
+        uint64_t time;
+        uint64_t task;
+        EKind kind;
+    };
+
+    explicit TTraceRecorder(size_t eventsPerThread = 1 << 16)
+        : capacity_(std::bit_ceil(std::max<size_t>(eventsPerThread, 2))), origin_(now()), generation_(nextGeneration()) {}
+
+    TTraceRecorder(const TTraceRecorder&) = delete;
+    TTraceRecorder& operator=(const TTraceRecorder&) = delete;
+
+    void record(EKind kind, uint64_t task) {
+        TRing& ring = localRing();
+        ring.events[ring.written & (capacity_ - 1)] = {now(), task, kind};
+        ++ring.written;
+    }
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto): one complete event per task
+    // on the thread that ran it, with the time it spent ready but not yet started.
+    void writeChromeTrace(std::ostream& out) const {
+        std::vector<TTaskSpan> spans = collect();
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const std::unique_ptr<TRing>& ring : rings_) {
+            out << (first ? "" : ",") << "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << ring->thread
+                << ",\"args\":{\"name\":\"thread " << ring->thread << "\"}}";
+            first = false;
+        }
+        out << std::fixed << std::setprecision(3);
+        for (const TTaskSpan& span : spans) {
+            if (span.start == kNone || span.finish == kNone) {
+                continue;
+            }
+            out << (first ? "" : ",") << "\n{\"ph\":\"X\",\"name\":\"task " << span.task << "\",\"pid\":1,\"tid\":"
+                << span.thread << ",\"ts\":" << micros(span.start) << ",\"dur\":" << micros(span.finish - span.start)
+                << ",\"args\":{\"queued_us\":" << micros(span.start - span.ready) << "}}";
+            first = false;
+        }
+        out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    }
+
+    // Useful work against everything else, per thread that ran tasks.
+    void writeSummary(std::ostream& out) const {
+        std::vector<TTaskSpan> spans = collect();
+        uint64_t begin = kNone;
+        uint64_t end = 0;
+        uint64_t busy = 0;
+        uint64_t queued = 0;
+        uint64_t waited = 0;
+        size_t tasks = 0;
+        std::map<uint32_t, uint64_t> busyPerThread;
+        for (const TTaskSpan& span : spans) {
+            if (span.start == kNone || span.finish == kNone) {
+                continue;
+            }
+            ++tasks;
+            begin = std::min(begin, span.ready);
+            end = std::max(end, span.finish);
+            busy += span.finish - span.start;
+            busyPerThread[span.thread] += span.finish - span.start;
+            queued += span.start - span.ready;
+            waited += span.ready - std::min(span.ready, span.begin);
+        }
+        if (tasks == 0) {
+            out << "no tasks traced" << std::endl;
+            return;
+        }
+
+        double wall = double(end - begin);
+        double capacity = wall * double(busyPerThread.size());
+        out << std::fixed << std::setprecision(3)
+            << "tasks: " << tasks << ", threads: " << busyPerThread.size() << ", dropped events: " << dropped() << "\n"
+            << "wall: " << wall / 1e6 << " ms, useful work: " << busy / 1e6 << " ms ("
+            << 100.0 * double(busy) / capacity << "% of thread time)\n"
+            << "scheduling and idle: " << (capacity - double(busy)) / 1e6 << " ms\n"
+            << "mean wait for dependencies: " << double(waited) / tasks / 1e3 << " us, mean time ready before start: "
+            << double(queued) / tasks / 1e3 << " us\n";
+        for (const auto& [thread, time] : busyPerThread) {
+            out << "thread " << thread << ": " << time / 1e6 << " ms busy\n";
+        }
+        out.flush();
+    }
+
+    size_t dropped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = 0;
+        for (const std::unique_ptr<TRing>& ring : rings_) {
+            count += ring->written > capacity_ ? ring->written - capacity_ : 0;
+        }
+        return count;
+    }
+
+private:
+    static constexpr uint64_t kNone = UINT64_MAX;
+
+    struct TRing {
+        std::unique_ptr<TEvent[]> events;
+        size_t written = 0;
+        uint32_t thread = 0;
+    };
+
+    struct TTaskSpan {
+        uint64_t task;
+        uint64_t begin = 0;
+        uint64_t ready = kNone;
+        uint64_t start = kNone;
+        uint64_t finish = kNone;
+        uint32_t thread = 0;
+    };
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static double micros(uint64_t nanos) {
+        return double(nanos) / 1e3;
+    }
+
+    static uint64_t nextGeneration() {
+        static std::atomic<uint64_t> generation{0};
+        return generation.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    TRing& localRing() {
+        // One cached ring per thread; a thread that records for several recorders in turn
+        // looks its ring up again, under the mutex, each time it switches. Generations
+        // rather than addresses identify recorders, since an address can be reused.
+        thread_local uint64_t owner = 0;
+        thread_local TRing* ring = nullptr;
+        if (owner == generation_) {
+            return *ring;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [it, inserted] = byThread_.try_emplace(std::this_thread::get_id(), nullptr);
+        if (inserted) {
+            auto fresh = std::make_unique<TRing>();
+            fresh->events = std::make_unique<TEvent[]>(capacity_);
+            fresh->thread = static_cast<uint32_t>(rings_.size());
+            it->second = fresh.get();
+            rings_.push_back(std::move(fresh));
+        }
+        owner = generation_;
+        ring = it->second;
+        return *ring;
+    }
+
+    // Merges the rings into one record per task, with times relative to the recorder's
+    // creation. A task's wait for dependencies is counted from the latest Begin before
+    // it became ready.
+    std::vector<TTaskSpan> collect() const {
+        std::vector<TEvent> events;
+        std::vector<uint32_t> threads;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const std::unique_ptr<TRing>& ring : rings_) {
+                size_t first = ring->written > capacity_ ? ring->written - capacity_ : 0;
+                for (size_t i = first; i < ring->written; ++i) {
+                    events.push_back(ring->events[i & (capacity_ - 1)]);
+                    threads.push_back(ring->thread);
+                }
+            }
+        }
+
+        std::vector<size_t> order(events.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&events](size_t a, size_t b) { return events[a].time < events[b].time; });
+
+        std::unordered_map<uint64_t, TTaskSpan> spans;
+        uint64_t begin = 0;
+        for (size_t i : order) {
+            const TEvent& event = events[i];
+            uint64_t time = event.time - std::min(event.time, origin_);
+            if (event.kind == EKind::Begin) {
+                begin = time;
+                continue;
+            }
+            TTaskSpan& span = spans.try_emplace(event.task, TTaskSpan{event.task}).first->second;
+            switch (event.kind) {
+                case EKind::Ready:
+                    span.begin = begin;
+                    span.ready = time;
+                    break;
+                case EKind::Start:
+                    span.start = time;
+                    span.thread = threads[i];
+                    if (span.ready == kNone) {
+                        span.begin = begin;
+                        span.ready = time;
+                    }
+                    break;
+                case EKind::Finish:
+                    span.finish = time;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        std::vector<TTaskSpan> result;
+        result.reserve(spans.size());
+        for (const auto& [task, span] : spans) {
+            result.push_back(span);
+        }
+        std::sort(result.begin(), result.end(), [](const TTaskSpan& a, const TTaskSpan& b) { return a.task < b.task; });
+        return result;
+    }
+
+    size_t capacity_;
+    uint64_t origin_;
+    uint64_t generation_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<TRing>> rings_;
+    std::unordered_map<std::thread::id, TRing*> byThread_;
+};
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <numeric>
+#include <sstream>
+
 #include "../lib/scheduler.h"
+#include "../lib/task_graph.h"
 
 
 class TTaskSchedulerTest : public ::testing::Test {
@@ -112,3 +116,601 @@ TEST_F(TTaskSchedulerTest, ExecuteAllChar) {
     EXPECT_EQ(scheduler.getResult<char>(id1), 'x');
     EXPECT_EQ(scheduler.getResult<char>(id2), 'y');
 }
+
+
+TEST(TTaskSchedulerParallelTest, QuadraticEquation) {
+    TTaskScheduler scheduler(4);
+    float a = 1;
+    float b = -2;
+    float c = 0;
+
+    auto id1 = scheduler.add([](float a, float c) { return -4 * a * c; }, a, c);
+    auto id2 = scheduler.add([](float b, float v) { return b * b + v; }, b, scheduler.getFutureResult<float>(id1));
+    auto id3 = scheduler.add([](float b, float d) { return -b + std::sqrt(d); }, b, scheduler.getFutureResult<float>(id2));
+    auto id4 = scheduler.add([](float b, float d) { return -b - std::sqrt(d); }, b, scheduler.getFutureResult<float>(id2));
+    auto id5 = scheduler.add([](float a, float v) { return v / (2 * a); }, a, scheduler.getFutureResult<float>(id3));
+    auto id6 = scheduler.add([](float a, float v) { return v / (2 * a); }, a, scheduler.getFutureResult<float>(id4));
+
+    scheduler.executeAll();
+    EXPECT_EQ(scheduler.getResult<float>(id5), 2);
+    EXPECT_EQ(scheduler.getResult<float>(id6), 0);
+}
+
+TEST(TTaskSchedulerParallelTest, DependentsSeeComputedResults) {
+    TTaskScheduler scheduler(3);
+    std::atomic<int> calls{0};
+
+    std::vector<size_t> ids;
+    ids.push_back(scheduler.add([&calls]() { ++calls; return 1; }));
+    for (int i = 1; i < 200; ++i) {
+        ids.push_back(scheduler.add([&calls](int a, int b) { ++calls; return a + b; },
+            scheduler.getFutureResult<int>(ids[i - 1]), scheduler.getFutureResult<int>(ids[i / 2])));
+    }
+
+    scheduler.executeAll();
+    EXPECT_EQ(calls.load(), 200);
+
+    std::vector<int> expected = {1};
+    for (int i = 1; i < 200; ++i) {
+        expected.push_back(expected[i - 1] + expected[i / 2]);
+    }
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_EQ(scheduler.getResult<int>(ids[i]), expected[i]);
+    }
+}
+
+TEST(TTaskSchedulerParallelTest, ZeroResultIsNotRecomputed) {
+    TTaskScheduler scheduler(2);
+    int calls = 0;
+    auto id = scheduler.add([&calls]() { ++calls; return 0; });
+    scheduler.executeAll();
+    EXPECT_EQ(scheduler.getResult<int>(id), 0);
+    EXPECT_EQ(scheduler.getResult<int>(id), 0);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST_F(TTaskSchedulerTest, ExceptionPropagatesToDependents) {
+    auto id1 = scheduler.add([]() -> int { throw std::runtime_error("failed"); });
+    auto id2 = scheduler.add([](int a) { return a + 1; }, scheduler.getFutureResult<int>(id1));
+    EXPECT_THROW(scheduler.executeAll(), std::runtime_error);
+    EXPECT_THROW(scheduler.getResult<int>(id2), std::runtime_error);
+}
+
+TEST(TTaskSchedulerParallelTest, ExceptionPropagatesToDependents) {
+    TTaskScheduler scheduler(2);
+    auto id1 = scheduler.add([]() -> int { throw std::runtime_error("failed"); });
+    auto id2 = scheduler.add([](int a) { return a + 1; }, scheduler.getFutureResult<int>(id1));
+    EXPECT_THROW(scheduler.executeAll(), std::runtime_error);
+    EXPECT_THROW(scheduler.getResult<int>(id2), std::runtime_error);
+}
+
+struct TThrowingCopy {
+    TThrowingCopy() = default;
+    TThrowingCopy(const TThrowingCopy&) {
+        throw std::runtime_error("copy failed");
+    }
+};
+
+static void addWithThrowingArgument(TTaskScheduler& scheduler) {
+    auto id1 = scheduler.add([]() { return 1; });
+    EXPECT_THROW(scheduler.add([](int a, const TThrowingCopy&) { return a; }, scheduler.getFutureResult<int>(id1), TThrowingCopy{}),
+        std::runtime_error);
+    auto id2 = scheduler.add([](int a) { return a + 1; }, scheduler.getFutureResult<int>(id1));
+    scheduler.executeAll();
+    EXPECT_EQ(scheduler.getResult<int>(id2), 2);
+}
+
+TEST_F(TTaskSchedulerTest, FailedAddDoesNotBlockExecution) {
+    addWithThrowingArgument(scheduler);
+}
+
+TEST(TTaskSchedulerParallelTest, FailedAddDoesNotBlockExecution) {
+    TTaskScheduler scheduler(2);
+    scheduler.setResultRelease(EResultRelease::WhenConsumed);
+    addWithThrowingArgument(scheduler);
+}
+
+TEST_F(TTaskSchedulerTest, LargeResults) {
+    auto id1 = scheduler.add([](int n) { return std::vector<int>(n, 7); }, 1000);
+    auto id2 = scheduler.add([](const std::vector<int>& v) { return std::string(v.size(), 'x'); },
+        scheduler.getFutureResult<std::vector<int>>(id1));
+    scheduler.executeAll();
+    EXPECT_EQ(scheduler.getResultRef<std::vector<int>>(id1).size(), 1000);
+    EXPECT_EQ(scheduler.getResult<std::string>(id2), std::string(1000, 'x'));
+}
+
+TEST_F(TTaskSchedulerTest, TakeResultMovesOut) {
+    auto id = scheduler.add([]() { return std::vector<int>(100, 1); });
+    const int* data = scheduler.getResultRef<std::vector<int>>(id).data();
+    std::vector<int> taken = scheduler.takeResult<std::vector<int>>(id);
+    EXPECT_EQ(taken.data(), data);
+    EXPECT_TRUE(scheduler.getResultRef<std::vector<int>>(id).empty());
+}
+
+TEST_F(TTaskSchedulerTest, ResultTypeIsChecked) {
+    auto id = scheduler.add([]() { return 24; });
+    EXPECT_THROW(scheduler.getResult<double>(id), std::bad_cast);
+    EXPECT_EQ(scheduler.getResult<int>(id), 24);
+}
+
+TEST_F(TTaskSchedulerTest, VoidTaskRunsOnce) {
+    int calls = 0;
+    scheduler.add([&calls]() { ++calls; });
+    scheduler.executeAll();
+    scheduler.executeAll();
+    EXPECT_EQ(calls, 1);
+}
+
+TEST_F(TTaskSchedulerTest, ArgumentsAreStoredByValue) {
+    int a = 24;
+    auto id = scheduler.add([](int a) { return a; }, a);
+    a = 0;
+    EXPECT_EQ(scheduler.getResult<int>(id), 24);
+}
+
+TEST_F(TTaskSchedulerTest, LargeCapturesAndMoveOnlyResults) {
+    std::array<double, 32> big{};
+    big.fill(1.5);
+    auto id1 = scheduler.add([big]() { return big[0] + big[31]; });
+    auto id2 = scheduler.add([](std::string s) { return std::make_unique<std::string>(s + "!"); }, std::string(100, 'a'));
+    scheduler.executeAll();
+    EXPECT_EQ(scheduler.getResult<double>(id1), 3.0);
+    EXPECT_EQ(scheduler.getResultRef<std::unique_ptr<std::string>>(id2)->size(), 101);
+}
+
+TEST_F(TTaskSchedulerTest, ManyTasksKeepStableIds) {
+    std::vector<size_t> ids;
+    ids.push_back(scheduler.add([]() { return 0; }));
+    for (int i = 1; i < 5000; ++i) {
+        ids.push_back(scheduler.add([](int a) { return a + 1; }, scheduler.getFutureResult<int>(ids.back())));
+    }
+    scheduler.executeAll();
+    EXPECT_EQ(scheduler.getResult<int>(ids.back()), 4999);
+}
+
+TEST(TTaskSchedulerConcurrentTest, ProducersAddConcurrently) {
+    TTaskScheduler scheduler;
+    const int producers = 4;
+    const int perProducer = 3000;
+    std::vector<std::vector<size_t>> ids(producers);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&scheduler, &ids, p] {
+            ids[p].push_back(scheduler.add([p]() { return p; }));
+            for (int i = 1; i < perProducer; ++i) {
+                ids[p].push_back(scheduler.add([](int a) { return a + 1; }, scheduler.getFutureResult<int>(ids[p].back())));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    scheduler.executeAll();
+    for (int p = 0; p < producers; ++p) {
+        EXPECT_EQ(scheduler.getResult<int>(ids[p].back()), p + perProducer - 1);
+    }
+}
+
+TEST(TTaskSchedulerConcurrentTest, GetResultWaitsForRunningTask) {
+    for (EWaitPolicy policy : {EWaitPolicy::Spin, EWaitPolicy::Block, EWaitPolicy::Help}) {
+        TTaskScheduler scheduler(2, policy);
+        std::atomic<bool> started{false};
+        std::atomic<int> calls{0};
+        auto id = scheduler.add([&started, &calls]() {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return ++calls;
+        });
+
+        std::thread runner([&scheduler, id] { scheduler.getResult<int>(id); });
+        while (!started) {
+            std::this_thread::yield();
+        }
+        EXPECT_EQ(scheduler.getResult<int>(id), 1);
+        runner.join();
+        EXPECT_EQ(calls.load(), 1);
+    }
+}
+
+TEST(TTaskSchedulerConcurrentTest, AddWhileExecuting) {
+    TTaskScheduler scheduler(2);
+    std::vector<size_t> first;
+    for (int i = 0; i < 1000; ++i) {
+        first.push_back(scheduler.add([i]() { return i; }));
+    }
+
+    std::vector<size_t> second;
+    std::thread producer([&] {
+        for (int i = 0; i < 1000; ++i) {
+            second.push_back(scheduler.add([](int a) { return 2 * a; }, scheduler.getFutureResult<int>(first[i])));
+        }
+    });
+    scheduler.executeAll();
+    producer.join();
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(scheduler.getResult<int>(second[i]), 2 * i);
+    }
+}
+
+TEST(TTaskSchedulerCoroutineTest, AwaitsFutureResult) {
+    for (size_t threads : {size_t(0), size_t(2)}) {
+        TTaskScheduler scheduler(threads);
+        auto id1 = scheduler.add([]() { return 20; });
+        auto id2 = scheduler.add([](FutureResult<int> a) -> TTask<int> {
+            int value = co_await a;
+            co_return value + 1;
+        }, scheduler.getFutureResult<int>(id1));
+        auto id3 = scheduler.add([](int a) { return a * 2; }, scheduler.getFutureResult<int>(id2));
+        scheduler.executeAll();
+        EXPECT_EQ(scheduler.getResult<int>(id3), 42);
+    }
+}
+
+TEST(TTaskSchedulerCoroutineTest, AwaitsLaterTask) {
+    TTaskScheduler scheduler;
+    size_t later = 1;
+    auto id1 = scheduler.add([&scheduler](size_t later) -> TTask<int> {
+        co_return co_await scheduler.getFutureResult<int>(later) + 1;
+    }, later);
+    auto id2 = scheduler.add([]() { return 6; });
+    EXPECT_EQ(id2, later);
+    scheduler.executeAll();
+    EXPECT_EQ(scheduler.getResult<int>(id1), 7);
+}
+
+TEST(TTaskSchedulerCoroutineTest, ManySuspendedOnEvent) {
+    TTaskScheduler scheduler(2);
+    TEvent ready;
+    std::vector<size_t> ids;
+    for (int i = 0; i < 1000; ++i) {
+        ids.push_back(scheduler.add([&ready](int i) -> TTask<int> {
+            co_await ready;
+            co_return i;
+        }, i));
+    }
+
+    std::thread signaller([&ready] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ready.set();
+    });
+    scheduler.executeAll();
+    signaller.join();
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(scheduler.getResult<int>(ids[i]), i);
+    }
+}
+
+TEST(TTaskSchedulerCoroutineTest, ExceptionIsStored) {
+    TTaskScheduler scheduler(2);
+    TEvent ready;
+    auto id = scheduler.add([&ready]() -> TTask<int> {
+        co_await ready;
+        throw std::runtime_error("failed");
+    });
+    std::thread signaller([&ready] { ready.set(); });
+    EXPECT_THROW(scheduler.getResult<int>(id), std::runtime_error);
+    signaller.join();
+}
+
+TEST(TTaskGraphTest, ReplaysWithNewInputs) {
+    TTaskGraph graph;
+    auto a = graph.input<float>();
+    auto b = graph.input<float>();
+    auto c = graph.input<float>();
+
+    auto id1 = graph.add([](float a, float c) { return -4 * a * c; }, a, c);
+    auto id2 = graph.add([](float b, float v) { return b * b + v; }, b, graph.getFutureResult<float>(id1));
+    auto id3 = graph.add([](float b, float d) { return -b + std::sqrt(d); }, b, graph.getFutureResult<float>(id2));
+    auto id4 = graph.add([](float b, float d) { return -b - std::sqrt(d); }, b, graph.getFutureResult<float>(id2));
+    auto id5 = graph.add([](float a, float v) { return v / (2 * a); }, a, graph.getFutureResult<float>(id3));
+    auto id6 = graph.add([](float a, float v) { return v / (2 * a); }, a, graph.getFutureResult<float>(id4));
+
+    TWorkStealingPool pool(2);
+    for (int run = 0; run < 2; ++run) {
+        graph.setInput(a, 1.0f);
+        graph.setInput(b, -2.0f);
+        graph.setInput(c, 0.0f);
+        run == 0 ? graph.run() : graph.run(pool);
+        EXPECT_EQ(graph.getResult<float>(id5), 2);
+        EXPECT_EQ(graph.getResult<float>(id6), 0);
+
+        graph.setInput(c, -3.0f);
+        run == 0 ? graph.run() : graph.run(pool);
+        EXPECT_EQ(graph.getResult<float>(id5), 3);
+        EXPECT_EQ(graph.getResult<float>(id6), -1);
+    }
+}
+
+TEST(TTaskGraphTest, ChecksTypesAndInputs) {
+    TTaskGraph graph;
+    auto text = graph.input<std::string>();
+    auto id = graph.add([](const std::string& s, int n) { return std::vector<std::string>(n, s); }, text, 3);
+    EXPECT_THROW(graph.getFutureResult<int>(id), std::bad_cast);
+    EXPECT_THROW(graph.run(), std::logic_error);
+    EXPECT_THROW(graph.add([]() { return 0; }), std::logic_error);
+
+    graph.setInput(text, "ab");
+    graph.run();
+    EXPECT_EQ(graph.getResultRef<std::vector<std::string>>(id), std::vector<std::string>(3, "ab"));
+}
+
+TEST(TTaskGraphTest, ParallelRunPropagatesException) {
+    TTaskGraph graph;
+    auto x = graph.input<int>();
+    auto id1 = graph.add([](int x) { if (x < 0) { throw std::runtime_error("negative"); } return x; }, x);
+    auto id2 = graph.add([](int v) { return v + 1; }, graph.getFutureResult<int>(id1));
+
+    TWorkStealingPool pool(2);
+    graph.setInput(x, -1);
+    EXPECT_THROW(graph.run(pool), std::runtime_error);
+    graph.setInput(x, 1);
+    graph.run(pool);
+    EXPECT_EQ(graph.getResult<int>(id2), 2);
+}
+
+TEST(TTaskSchedulerDispatchTest, PriorityOrdersReadyTasks) {
+    TTaskScheduler scheduler(1);
+    scheduler.setDispatchOrder(EDispatchOrder::Priority);
+    std::mutex mutex;
+    std::vector<int> started;
+
+    for (int priority = 0; priority < 6; ++priority) {
+        auto id = scheduler.add([&mutex, &started](int priority) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                started.push_back(priority);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            return priority;
+        }, priority);
+        scheduler.setPriority(id, priority);
+    }
+    scheduler.executeAll();
+
+    // The pool worker and the thread in executeAll() take tasks in pairs.
+    ASSERT_EQ(started.size(), 6);
+    EXPECT_TRUE(started[0] == 5 || started[1] == 5);
+    EXPECT_TRUE(started[4] == 0 || started[5] == 0);
+}
+
+TEST(TTaskSchedulerDispatchTest, CriticalPathStartsLongChainFirst) {
+    TTaskScheduler scheduler(1);
+    scheduler.setDispatchOrder(EDispatchOrder::CriticalPath);
+    std::mutex mutex;
+    std::vector<int> started;
+    auto work = [&mutex, &started](int label, int) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            started.push_back(label);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        return label;
+    };
+
+    for (int i = 0; i < 6; ++i) {
+        scheduler.add(work, i, 0);
+    }
+    auto head = scheduler.add(work, 100, 0);
+    auto id = head;
+    for (int i = 1; i < 4; ++i) {
+        id = scheduler.add(work, 100 + i, scheduler.getFutureResult<int>(id));
+    }
+    scheduler.executeAll();
+
+    ASSERT_EQ(started.size(), 10);
+    EXPECT_TRUE(started[0] == 100 || started[1] == 100);
+    EXPECT_EQ(scheduler.getResult<int>(id), 103);
+}
+
+TEST(TTaskSchedulerTraceTest, ExportsEveryTask) {
+    TTaskScheduler scheduler(2);
+    scheduler.enableTracing();
+    auto left = scheduler.add([]() { return 1; });
+    auto right = scheduler.add([]() { return 2; });
+    auto sum = scheduler.add([](int a, int b) { return a + b; },
+        scheduler.getFutureResult<int>(left), scheduler.getFutureResult<int>(right));
+    scheduler.executeAll();
+    ASSERT_EQ(scheduler.getResult<int>(sum), 3);
+
+    std::ostringstream trace;
+    scheduler.tracer()->writeChromeTrace(trace);
+    std::string json = trace.str();
+    EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0);
+    size_t spans = 0;
+    for (size_t at = json.find("\"ph\":\"X\""); at != std::string::npos; at = json.find("\"ph\":\"X\"", at + 1)) {
+        ++spans;
+    }
+    EXPECT_EQ(spans, 3);
+
+    std::ostringstream summary;
+    scheduler.tracer()->writeSummary(summary);
+    EXPECT_NE(summary.str().find("tasks: 3,"), std::string::npos);
+    EXPECT_EQ(scheduler.tracer()->dropped(), 0);
+}
+
+TEST(TTaskSchedulerTraceTest, DisabledByDefault) {
+    TTaskScheduler scheduler;
+    scheduler.add([]() { return 1; });
+    scheduler.executeAll();
+    EXPECT_EQ(scheduler.tracer(), nullptr);
+}
+
+TEST(TTaskSchedulerParallelLoopTest, ForVisitsEveryIndexOnce) {
+    TTaskScheduler scheduler(3);
+    std::vector<std::atomic<int>> visits(10000);
+    auto step = scheduler.add([]() { return 2; });
+    scheduler.addParallelFor({0, visits.size(), 16}, [&visits](size_t i, int step) {
+        visits[i].fetch_add(step);
+    }, scheduler.getFutureResult<int>(step));
+    scheduler.executeAll();
+
+    for (const std::atomic<int>& count : visits) {
+        ASSERT_EQ(count.load(), 2);
+    }
+}
+
+TEST(TTaskSchedulerParallelLoopTest, ReduceFeedsDependents) {
+    for (size_t threads : {0, 1, 3}) {
+        TTaskScheduler scheduler(threads);
+        auto offset = scheduler.add([]() { return int64_t(1); });
+        auto sum = scheduler.addParallelReduce({0, 100000, 8}, int64_t(0),
+            [](size_t i, int64_t offset) { return int64_t(i) + offset; },
+            [](int64_t a, int64_t b) { return a + b; },
+            scheduler.getFutureResult<int64_t>(offset));
+        auto half = scheduler.add([](int64_t total) { return total / 2; }, scheduler.getFutureResult<int64_t>(sum));
+        scheduler.executeAll();
+
+        const int64_t expected = int64_t(100000) * 99999 / 2 + 100000;
+        EXPECT_EQ(scheduler.getResult<int64_t>(sum), expected);
+        EXPECT_EQ(scheduler.getResult<int64_t>(half), expected / 2);
+    }
+}
+
+TEST(TTaskSchedulerParallelLoopTest, EmptyRangeGivesIdentity) {
+    TTaskScheduler scheduler(2);
+    auto sum = scheduler.addParallelReduce({5, 5}, 7, [](size_t i) { return int(i); }, [](int a, int b) { return a + b; });
+    EXPECT_EQ(scheduler.getResult<int>(sum), 7);
+}
+
+TEST(TTaskSchedulerParallelLoopTest, ExceptionIsStored) {
+    TTaskScheduler scheduler(2);
+    auto sum = scheduler.addParallelReduce({0, 5000, 1}, 0, [](size_t i) {
+        if (i == 4321) {
+            throw std::runtime_error("bad index");
+        }
+        return 1;
+    }, [](int a, int b) { return a + b; });
+    EXPECT_THROW(scheduler.executeAll(), std::runtime_error);
+    EXPECT_THROW(scheduler.getResult<int>(sum), std::runtime_error);
+}
+
+// A sum that cannot be copied or moved once it reaches kTotal, i.e. when the loop
+// publishes its result (or merges a job that covered the whole range).
+struct TFragileSum {
+    static constexpr int kTotal = 5000;
+
+    int value = 0;
+
+    TFragileSum(int v) : value(v) {}
+
+    TFragileSum(const TFragileSum& other) : value(other.value) {
+        if (value == kTotal) {
+            throw std::runtime_error("cannot copy the total");
+        }
+    }
+
+    TFragileSum& operator=(const TFragileSum&) = default;
+};
+
+TEST(TTaskSchedulerParallelLoopTest, PublishErrorIsStored) {
+    TTaskScheduler scheduler(2);
+    auto sum = scheduler.addParallelReduce({0, size_t(TFragileSum::kTotal), 1}, TFragileSum(0), [](size_t) { return TFragileSum(1); },
+        [](const TFragileSum& a, const TFragileSum& b) { return TFragileSum(a.value + b.value); });
+    EXPECT_THROW(scheduler.executeAll(), std::runtime_error);
+    EXPECT_THROW(scheduler.getResult<TFragileSum>(sum), std::runtime_error);
+}
+
+TEST(TTaskSchedulerReleaseTest, ConsumedResultsAreDestroyed) {
+    for (size_t threads : {0, 2}) {
+        TTaskScheduler scheduler(threads);
+        scheduler.setResultRelease(EResultRelease::WhenConsumed);
+        std::weak_ptr<int> first;
+        auto a = scheduler.add([&first]() {
+            auto value = std::make_shared<int>(1);
+            first = value;
+            return value;
+        });
+        auto pinned = scheduler.add([](std::shared_ptr<int> value) { return *value + 1; },
+            scheduler.getFutureResult<std::shared_ptr<int>>(a));
+        scheduler.keepResult(pinned);
+        auto last = scheduler.add([](int value) { return value * 10; }, scheduler.getFutureResult<int>(pinned));
+        scheduler.executeAll();
+
+        EXPECT_TRUE(first.expired());
+        EXPECT_THROW(scheduler.getResult<std::shared_ptr<int>>(a), std::logic_error);
+        EXPECT_EQ(scheduler.getResult<int>(pinned), 2);
+        EXPECT_EQ(scheduler.getResult<int>(last), 20);
+    }
+}
+
+TEST(TTaskSchedulerReleaseTest, CancelSkipsSubgraph) {
+    for (size_t threads : {0, 2}) {
+        TTaskScheduler scheduler(threads);
+        std::atomic<int> runs{0};
+        auto a = scheduler.add([&runs]() { return ++runs; });
+        auto b = scheduler.add([&runs](int) { return ++runs; }, scheduler.getFutureResult<int>(a));
+        auto c = scheduler.add([&runs](int) { return ++runs; }, scheduler.getFutureResult<int>(b));
+        auto d = scheduler.add([&runs]() { return ++runs; });
+
+        EXPECT_EQ(scheduler.cancel(b), 2);
+        EXPECT_NO_THROW(scheduler.executeAll());
+        EXPECT_EQ(runs.load(), 2);
+        EXPECT_NO_THROW(scheduler.getResult<int>(a));
+        EXPECT_NO_THROW(scheduler.getResult<int>(d));
+        EXPECT_THROW(scheduler.getResult<int>(c), TTaskCancelled);
+        EXPECT_EQ(scheduler.cancel(a), 0);
+    }
+}
+
+TEST(TTaskSchedulerReleaseTest, ClearStartsOver) {
+    TTaskScheduler scheduler(2);
+    scheduler.setResultRelease(EResultRelease::WhenConsumed);
+    for (int batch = 0; batch < 3; ++batch) {
+        auto a = scheduler.add([batch]() { return std::vector<int>(1000, batch); });
+        auto sum = scheduler.add([](const std::vector<int>& values) {
+            return std::accumulate(values.begin(), values.end(), 0);
+        }, scheduler.getFutureResult<std::vector<int>>(a));
+        scheduler.executeAll();
+        EXPECT_EQ(a, 0);
+        EXPECT_EQ(scheduler.getResult<int>(sum), 1000 * batch);
+        scheduler.clear();
+    }
+}
+
+static int countedSquare(int x) {
+    static std::atomic<int> calls{0};
+    return ++calls > 0 ? x * x : 0;
+}
+
+TEST(TTaskSchedulerMemoTest, DuplicatesShareOneTask) {
+    for (size_t threads : {0, 2}) {
+        TTaskScheduler scheduler(threads);
+        scheduler.enableMemoization();
+        std::vector<size_t> sums;
+        for (int i = 0; i < 4; ++i) {
+            auto square = scheduler.add(&countedSquare, 3);
+            auto other = scheduler.add(&countedSquare, 4);
+            sums.push_back(scheduler.add([](int a, int b) { return a + b; },
+                scheduler.getFutureResult<int>(square), scheduler.getFutureResult<int>(other)));
+        }
+        scheduler.executeAll();
+
+        EXPECT_EQ(sums[1], sums[0]);
+        EXPECT_EQ(sums[3], sums[0]);
+        EXPECT_EQ(scheduler.getResult<int>(sums[0]), 25);
+        TMemoTable::TStats stats = scheduler.memoStats();
+        EXPECT_EQ(stats.misses, 3);
+        EXPECT_EQ(stats.hits, 9);
+    }
+}
+
+TEST(TTaskSchedulerMemoTest, DistinguishesCallablesAndArguments) {
+    TTaskScheduler scheduler;
+    scheduler.enableMemoization();
+    auto a = scheduler.add([](std::string s) { return s + "!"; }, std::string("x"));
+    auto b = scheduler.add([](std::string s) { return s + "?"; }, std::string("x"));
+    auto c = scheduler.add([](std::string s) { return s + "!"; }, std::string("y"));
+    int offset = 1;
+    auto d = scheduler.add([offset](int x) { return x + offset; }, 1);
+    auto e = scheduler.add([offset](int x) { return x + offset; }, 1);
+
+    EXPECT_NE(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_NE(d, e);
+    EXPECT_EQ(scheduler.getResult<std::string>(b), "x?");
+    EXPECT_EQ(scheduler.memoStats().hits, 0);
+}
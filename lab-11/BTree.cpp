@@ -1,4 +1,4 @@
-#include "btree.h"
+#include "BTree.h"
 
 BTree::BTree() {
 	root = new BTNode();
@@ -260,4 +260,232 @@ bool BTree::search(Record& a_record)
 PBTNode BTree::get_root()
 {
 	return root;
-}
\ No newline at end of file
+}
+
+BTreeCursor::BTreeCursor(BTree& bt) : BTreeCursor(bt.get_root()) {}
+
+BTreeCursor::BTreeCursor(PBTNode a_root) {
+	root = a_root;
+	depth = 0;
+	is_valid = false;
+}
+
+void BTreeCursor::descend_leftmost(PBTNode pnode) {
+	while (pnode) {
+		path[depth] = pnode;
+		index[depth] = 0;
+		pnode = pnode->child[0];
+
+		if (pnode)
+			depth++;
+	}
+
+	is_valid = path[depth]->data_num != 0;
+	prefetch_next();
+}
+
+void BTreeCursor::descend_rightmost(PBTNode pnode) {
+	while (pnode) {
+		path[depth] = pnode;
+		index[depth] = pnode->data_num;
+		pnode = pnode->child[pnode->data_num];
+
+		if (pnode)
+			depth++;
+	}
+
+	is_valid = path[depth]->data_num != 0;
+	if (is_valid)
+		index[depth]--;
+}
+
+bool BTreeCursor::ascend_forward() {
+	while (depth > 0) {
+		depth--;
+
+		if (index[depth] < path[depth]->data_num) {
+			prefetch_next();
+			return true;
+		}
+	}
+
+	is_valid = false;
+	return false;
+}
+
+bool BTreeCursor::ascend_backward() {
+	while (depth > 0) {
+		depth--;
+
+		if (index[depth] > 0) {
+			index[depth]--;
+			return true;
+		}
+	}
+
+	is_valid = false;
+	return false;
+}
+
+// The node visited after the current leaf is the next child of its parent; pull it into
+// cache while the leaf's records are still being consumed.
+void BTreeCursor::prefetch_next() {
+#if defined(__GNUC__) || defined(__clang__)
+	PBTNode next_node = NULL;
+
+	if (path[depth]->child[0])
+		next_node = path[depth]->child[index[depth] + 1];
+	else if (depth > 0 && index[depth - 1] < path[depth - 1]->data_num)
+		next_node = path[depth - 1]->child[index[depth - 1] + 1];
+
+	if (next_node) {
+		__builtin_prefetch(next_node);
+		__builtin_prefetch(&next_node->data[0]);
+	}
+#endif
+}
+
+bool BTreeCursor::first() {
+	depth = 0;
+	is_valid = false;
+
+	if (root)
+		descend_leftmost(root);
+
+	return is_valid;
+}
+
+bool BTreeCursor::last() {
+	depth = 0;
+	is_valid = false;
+
+	if (root)
+		descend_rightmost(root);
+
+	return is_valid;
+}
+
+bool BTreeCursor::next() {
+	if (!is_valid)
+		return false;
+
+	PBTNode current_pnode = path[depth];
+
+	if (current_pnode->child[0]) {
+		index[depth]++;
+		depth++;
+		descend_leftmost(current_pnode->child[index[depth - 1]]);
+		return is_valid;
+	}
+
+	if (index[depth] + 1 < current_pnode->data_num) {
+		index[depth]++;
+		return true;
+	}
+
+	return ascend_forward();
+}
+
+bool BTreeCursor::prev() {
+	if (!is_valid)
+		return false;
+
+	PBTNode current_pnode = path[depth];
+
+	if (current_pnode->child[0]) {
+		depth++;
+		descend_rightmost(current_pnode->child[index[depth - 1]]);
+		return is_valid;
+	}
+
+	if (index[depth] > 0) {
+		index[depth]--;
+		return true;
+	}
+
+	return ascend_backward();
+}
+
+bool BTreeCursor::seek(const std::string& a_word) {
+	depth = 0;
+	is_valid = false;
+
+	if (!root)
+		return false;
+
+	PBTNode current_pnode = root;
+
+	while (true) {
+		size_t low = 0;
+		size_t high = current_pnode->data_num;
+
+		while (low < high) {
+			size_t middle = (low + high) / 2;
+
+			if (*(current_pnode->data[middle].word) < a_word)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		path[depth] = current_pnode;
+		index[depth] = low;
+
+		if (low < current_pnode->data_num && *(current_pnode->data[low].word) == a_word) {
+			is_valid = true;
+			prefetch_next();
+			return true;
+		}
+
+		if (current_pnode->child[0] == NULL)
+			break;
+
+		current_pnode = current_pnode->child[low];
+		depth++;
+	}
+
+	if (index[depth] < path[depth]->data_num) {
+		is_valid = true;
+		prefetch_next();
+		return true;
+	}
+
+	is_valid = true;
+	return ascend_forward();
+}
+
+size_t BTreeCursor::next_batch(Record** out, size_t n) {
+	size_t count = 0;
+
+	while (is_valid && count < n) {
+		PBTNode current_pnode = path[depth];
+
+		if (current_pnode->child[0] == NULL) {
+			size_t i = index[depth];
+
+			while (count < n && i < current_pnode->data_num)
+				out[count++] = &current_pnode->data[i++];
+
+			if (i < current_pnode->data_num) {
+				index[depth] = i;
+				break;
+			}
+
+			index[depth] = current_pnode->data_num - 1;
+		} else {
+			out[count++] = &current_pnode->data[index[depth]];
+		}
+
+		next();
+	}
+
+	return count;
+}
+
+bool BTreeCursor::valid() const {
+	return is_valid;
+}
+
+Record& BTreeCursor::record() const {
+	return path[depth]->data[index[depth]];
+}
@@ -8,6 +8,7 @@
 #include <sstream>
 
 #define M 71 // BTree Order (odd)
+#define BT_MAX_DEPTH 32 // Cursor path capacity, far above any height reachable with order M
 
 struct Position {
 	size_t pos_num;
@@ -67,4 +68,37 @@ public:
 	bool insert(std::string *a_word, size_t doc_id, size_t pos_num);
 	bool search(Record &a_record);
 	PBTNode get_root();
+};
+
+// Ordered, non-recursive cursor over a BTree (or any subtree of it).
+// The root-to-key path lives in fixed arrays, so moving the cursor never allocates.
+// At the current level `index` is a key index; on ancestor levels it is the index
+// of the child the cursor descended into, which is also the key that follows that child.
+class BTreeCursor {
+private:
+	PBTNode root;
+	PBTNode path[BT_MAX_DEPTH];
+	size_t index[BT_MAX_DEPTH];
+	size_t depth;
+	bool is_valid;
+
+	void descend_leftmost(PBTNode pnode);
+	void descend_rightmost(PBTNode pnode);
+	bool ascend_forward();
+	bool ascend_backward();
+	void prefetch_next();
+
+public:
+	explicit BTreeCursor(BTree& bt);
+	explicit BTreeCursor(PBTNode a_root);
+
+	bool first();
+	bool last();
+	bool next();
+	bool prev();
+	bool seek(const std::string& a_word); // first record with word >= a_word
+	size_t next_batch(Record** out, size_t n); // up to n records from the current one, moving past them
+
+	bool valid() const;
+	Record& record() const;
 };
\ No newline at end of file
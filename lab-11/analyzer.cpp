@@ -0,0 +1,255 @@
+#include "analyzer.h"
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ANALYZER_SSE2 1
+#endif
+
+namespace {
+
+const size_t kBlock = 16;
+
+bool IsAsciiWordChar(unsigned char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+char FoldAscii(unsigned char c) {
+	return static_cast<char>(c >= 'A' && c <= 'Z' ? c + 32 : c);
+}
+
+// Decodes one UTF-8 sequence; returns its length, or 0 for a malformed/truncated one.
+size_t DecodeUtf8(const unsigned char* p, const unsigned char* end, uint32_t& cp) {
+	size_t length;
+
+	if (p[0] < 0x80) {
+		cp = p[0];
+		return 1;
+	} else if ((p[0] & 0xE0) == 0xC0) {
+		cp = p[0] & 0x1F;
+		length = 2;
+	} else if ((p[0] & 0xF0) == 0xE0) {
+		cp = p[0] & 0x0F;
+		length = 3;
+	} else if ((p[0] & 0xF8) == 0xF0) {
+		cp = p[0] & 0x07;
+		length = 4;
+	} else {
+		return 0;
+	}
+
+	if (static_cast<size_t>(end - p) < length)
+		return 0;
+
+	for (size_t i = 1; i < length; i++) {
+		if ((p[i] & 0xC0) != 0x80)
+			return 0;
+		cp = (cp << 6) | (p[i] & 0x3F);
+	}
+
+	static const uint32_t kMinForLength[] = { 0, 0, 0x80, 0x800, 0x10000 };
+	if (cp < kMinForLength[length] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+		return 0;
+
+	return length;
+}
+
+void EncodeUtf8(uint32_t cp, std::string& out) {
+	if (cp < 0x80) {
+		out += static_cast<char>(cp);
+	} else if (cp < 0x800) {
+		out += static_cast<char>(0xC0 | (cp >> 6));
+		out += static_cast<char>(0x80 | (cp & 0x3F));
+	} else if (cp < 0x10000) {
+		out += static_cast<char>(0xE0 | (cp >> 12));
+		out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		out += static_cast<char>(0x80 | (cp & 0x3F));
+	} else {
+		out += static_cast<char>(0xF0 | (cp >> 18));
+		out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+		out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		out += static_cast<char>(0x80 | (cp & 0x3F));
+	}
+}
+
+// Non-ASCII code points are term characters unless they are spaces, punctuation or symbols.
+bool IsWordCodePoint(uint32_t cp) {
+	if (cp < 0x80)
+		return IsAsciiWordChar(static_cast<unsigned char>(cp));
+	if (cp < 0xC0)
+		return cp == 0xAA || cp == 0xB5 || cp == 0xBA;
+	if (cp == 0xD7 || cp == 0xF7)
+		return false;
+	if (cp >= 0x2000 && cp <= 0x2BFF)
+		return false;
+	if (cp >= 0x3000 && cp <= 0x303F)
+		return false;
+	if (cp >= 0xFE30 && cp <= 0xFE4F)
+		return false;
+	if ((cp >= 0xFF00 && cp <= 0xFF0F) || (cp >= 0xFF1A && cp <= 0xFF20) || cp == 0xFEFF)
+		return false;
+	return true;
+}
+
+// Simple case folding; every mapping but U+0130 stays within the same UTF-8 length.
+uint32_t FoldCodePoint(uint32_t cp) {
+	if (cp < 0x80)
+		return static_cast<unsigned char>(FoldAscii(static_cast<unsigned char>(cp)));
+	if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7)
+		return cp + 0x20;
+	// 'İ' folds to a plain 'i', not to its neighbour the dotless 'ı'.
+	if (cp == 0x130)
+		return 'i';
+	if ((cp >= 0x100 && cp <= 0x137) || (cp >= 0x14A && cp <= 0x177))
+		return cp | 1;
+	if (cp >= 0x139 && cp <= 0x148 && (cp & 1))
+		return cp + 1;
+	if (cp >= 0x391 && cp <= 0x3A9 && cp != 0x3A2)
+		return cp + 0x20;
+	if (cp >= 0x400 && cp <= 0x40F)
+		return cp + 0x50;
+	if (cp >= 0x410 && cp <= 0x42F)
+		return cp + 0x20;
+	return cp;
+}
+
+// Shared state of one analyze() call: the term being assembled and its position.
+struct Splitter {
+	const std::vector<std::unique_ptr<TokenFilter>>& filters;
+	const Analyzer::TokenCallback& on_token;
+	std::string token;
+	size_t position = 0;
+
+	void emit() {
+		if (token.empty())
+			return;
+
+		position++;
+
+		bool keep = true;
+		for (size_t i = 0; keep && i < filters.size(); i++)
+			keep = filters[i]->apply(token);
+
+		if (keep)
+			on_token(token, position);
+		token.clear();
+	}
+};
+
+} // namespace
+
+StopWordFilter::StopWordFilter()
+	: StopWordFilter({ "a", "an", "and", "are", "as", "at", "be", "but", "by", "for", "if", "in", "into",
+		"is", "it", "no", "not", "of", "on", "or", "such", "that", "the", "their", "then", "there", "these",
+		"they", "this", "to", "was", "will", "with" }) {}
+
+StopWordFilter::StopWordFilter(std::initializer_list<std::string> words) : stop_words(words) {}
+
+bool StopWordFilter::apply(std::string& token) const {
+	return stop_words.find(token) == stop_words.end();
+}
+
+bool PluralStemmer::apply(std::string& token) const {
+	size_t size = token.size();
+
+	if (size > 3 && token.compare(size - 3, 3, "ies") == 0 && token[size - 4] != 'e' && token[size - 4] != 'a') {
+		token.replace(size - 3, 3, "y");
+	} else if (size > 2 && token.compare(size - 2, 2, "es") == 0 && token[size - 3] != 'a' && token[size - 3] != 'e' && token[size - 3] != 'o') {
+		token.resize(size - 1);
+	} else if (size > 1 && token[size - 1] == 's' && token[size - 2] != 'u' && token[size - 2] != 's') {
+		token.resize(size - 1);
+	}
+
+	return true;
+}
+
+Analyzer& Analyzer::add_filter(std::unique_ptr<TokenFilter> filter) {
+	filters.push_back(std::move(filter));
+	return *this;
+}
+
+size_t Analyzer::analyze(std::string_view text, const TokenCallback& on_token) const {
+	Splitter splitter{ filters, on_token };
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+	const unsigned char* end = p + text.size();
+
+	while (p < end) {
+#ifdef ANALYZER_SSE2
+		if (end - p >= static_cast<ptrdiff_t>(kBlock)) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+			if (_mm_movemask_epi8(v) == 0) {
+				__m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+				__m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+				__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+				__m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+				__m128i word = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, underscore));
+
+				alignas(16) char folded[kBlock];
+				_mm_store_si128(reinterpret_cast<__m128i*>(folded), _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8(0x20))));
+				unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(word));
+
+				size_t i = 0;
+				while (i < kBlock) {
+					unsigned rest = mask >> i;
+
+					if (rest & 1) {
+						size_t run = std::countr_one(rest);
+						splitter.token.append(folded + i, run);
+						i += run;
+					} else {
+						splitter.emit();
+						i += rest ? std::countr_zero(rest) : kBlock - i;
+					}
+				}
+
+				p += kBlock;
+				continue;
+			}
+		}
+#endif
+		// Scalar path: one code point at a time, until the next block boundary.
+		const unsigned char* block_end = end - p > static_cast<ptrdiff_t>(kBlock) ? p + kBlock : end;
+
+		while (p < block_end) {
+			if (*p < 0x80) {
+				if (IsAsciiWordChar(*p))
+					splitter.token += FoldAscii(*p);
+				else
+					splitter.emit();
+				p++;
+				continue;
+			}
+
+			uint32_t cp;
+			size_t length = DecodeUtf8(p, end, cp);
+
+			if (length == 0) {
+				splitter.emit();
+				p++;
+			} else {
+				if (IsWordCodePoint(cp))
+					EncodeUtf8(FoldCodePoint(cp), splitter.token);
+				else
+					splitter.emit();
+				p += length;
+			}
+		}
+	}
+
+	splitter.emit();
+	return splitter.position;
+}
+
+std::vector<std::string> Analyzer::analyze(std::string_view text) const {
+	std::vector<std::string> tokens;
+	analyze(text, [&tokens](std::string& token, size_t) { tokens.push_back(token); });
+	return tokens;
+}
+
+const Analyzer& Analyzer::Default() {
+	static const Analyzer analyzer;
+	return analyzer;
+}
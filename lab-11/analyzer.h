@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// A token filter rewrites a token in place; returning false drops it from the stream.
+class TokenFilter {
+public:
+	virtual ~TokenFilter() = default;
+	virtual bool apply(std::string& token) const = 0;
+};
+
+class StopWordFilter : public TokenFilter {
+private:
+	std::unordered_set<std::string> stop_words;
+
+public:
+	StopWordFilter();
+	StopWordFilter(std::initializer_list<std::string> words);
+
+	bool apply(std::string& token) const override;
+};
+
+// Harman's "S" stemmer: folds English plurals (queries -> query, boxes -> boxe, cats -> cat).
+class PluralStemmer : public TokenFilter {
+public:
+	bool apply(std::string& token) const override;
+};
+
+// Splits text into terms and folds their case, then runs the configured filters.
+//
+// Terms are maximal runs of letters, digits, '_' and non-punctuation code points, so
+// "data," and "Data" both become "data". Case folding covers ASCII, Latin-1, Latin
+// Extended-A, Greek and Cyrillic; every mapping keeps its UTF-8 length except U+0130
+// 'İ' -> 'i', and folded code points are re-encoded into the term. Pure ASCII input
+// is split and folded 16 bytes at a time with SSE2 where available; blocks containing
+// multi-byte sequences drop to a per-code-point UTF-8 path.
+class Analyzer {
+private:
+	std::vector<std::unique_ptr<TokenFilter>> filters;
+
+public:
+	using TokenCallback = std::function<void(std::string& token, size_t position)>;
+
+	Analyzer() = default;
+	Analyzer(Analyzer&&) = default;
+	Analyzer& operator=(Analyzer&&) = default;
+
+	Analyzer& add_filter(std::unique_ptr<TokenFilter> filter);
+
+	// Positions count every split term from 1, including ones later dropped by a filter.
+	size_t analyze(std::string_view text, const TokenCallback& on_token) const;
+	std::vector<std::string> analyze(std::string_view text) const;
+
+	static const Analyzer& Default();
+};
@@ -0,0 +1,79 @@
+#include "analyzer.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Tokenization throughput in MB/s for ASCII and UTF-8 corpora.
+// Usage: analyzer_bench [megabytes]
+
+static std::string MakeCorpus(size_t bytes, bool utf8) {
+	static const char* kAscii[] = { "The", "vector", "of", "Data,", "while", "(for", "std::map", "queries.",
+		"BTree", "insert", "node->child[i]", "return", "size_t", "AND", "list" };
+	static const char* kUtf8[] = { "Привет,", "мир", "Данные", "über", "Straße", "ΑΒΓ", "déjà", "vector",
+		"поиск", "индекс", "—", "«слово»", "data", "for", "Ёлка" };
+
+	std::string corpus;
+	corpus.reserve(bytes + 32);
+	size_t seed = 1;
+
+	while (corpus.size() < bytes) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		corpus += (utf8 ? kUtf8 : kAscii)[(seed >> 33) % 15];
+		corpus += (seed >> 40) % 8 == 0 ? '\n' : ' ';
+	}
+
+	return corpus;
+}
+
+static size_t LegacyTokenize(const std::string& text) {
+	std::istringstream in(text);
+	std::string word;
+	size_t checksum = 0;
+
+	while (in >> word) {
+		for (size_t i = 0; i < word.size(); i++) {
+			if (word[i] >= 'A' && word[i] <= 'Z')
+				word[i] += 32;
+		}
+		checksum += word.size();
+	}
+
+	return checksum;
+}
+
+template<typename Tokenize>
+static void Report(const char* name, const std::string& corpus, Tokenize tokenize) {
+	auto start = std::chrono::steady_clock::now();
+	size_t checksum = tokenize(corpus);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << name << ": " << corpus.size() / 1e6 / elapsed.count() << " MB/s"
+		<< " (checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	size_t megabytes = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 64;
+
+	Analyzer full;
+	full.add_filter(std::make_unique<StopWordFilter>()).add_filter(std::make_unique<PluralStemmer>());
+
+	auto analyze = [](const Analyzer& analyzer) {
+		return [&analyzer](const std::string& text) {
+			size_t checksum = 0;
+			analyzer.analyze(text, [&checksum](std::string& token, size_t) { checksum += token.size(); });
+			return checksum;
+		};
+	};
+
+	for (bool utf8 : { false, true }) {
+		std::string corpus = MakeCorpus(megabytes << 20, utf8);
+		std::cout << (utf8 ? "utf-8" : "ascii") << " corpus, " << megabytes << " MB" << std::endl;
+
+		Report("  legacy whitespace split", corpus, LegacyTokenize);
+		Report("  analyzer", corpus, analyze(Analyzer::Default()));
+		Report("  analyzer + stop words + stemmer", corpus, analyze(full));
+	}
+}
@@ -0,0 +1,79 @@
+#include "BTree.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Full-scan throughput of the ordered BTree traversals.
+// Usage: btree_cursor_bench [words] [rounds]
+
+static size_t RecursiveScan(PBTNode pnode) {
+	size_t checksum = 0;
+	size_t i;
+
+	for (i = 0; i < pnode->data_num; i++) {
+		if (pnode->child[i])
+			checksum += RecursiveScan(pnode->child[i]);
+		checksum += pnode->data[i].word->size();
+	}
+
+	if (pnode->child[i])
+		checksum += RecursiveScan(pnode->child[i]);
+
+	return checksum;
+}
+
+static size_t CursorScan(BTree& bt) {
+	size_t checksum = 0;
+	BTreeCursor cursor(bt);
+
+	for (bool has_record = cursor.first(); has_record; has_record = cursor.next())
+		checksum += cursor.record().word->size();
+
+	return checksum;
+}
+
+static size_t BatchScan(BTree& bt) {
+	size_t checksum = 0;
+	BTreeCursor cursor(bt);
+	Record* batch[256];
+
+	cursor.first();
+	while (size_t count = cursor.next_batch(batch, 256)) {
+		for (size_t i = 0; i < count; i++)
+			checksum += batch[i]->word->size();
+	}
+
+	return checksum;
+}
+
+template<typename Scan>
+static void Report(const char* name, size_t words, size_t rounds, Scan scan) {
+	size_t checksum = 0;
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t round = 0; round < rounds; round++)
+		checksum += scan();
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	double records_per_second = static_cast<double>(words) * rounds / elapsed.count();
+
+	std::cout << name << ": " << records_per_second / 1e6 << " Mrecords/s"
+		<< " (checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	size_t words = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1000000;
+	size_t rounds = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 10;
+
+	BTree bt;
+	for (size_t i = 0; i < words; i++)
+		bt.insert(new std::string("term" + std::to_string((i * 2654435761u) % words)), 1, i + 1);
+
+	std::cout << "words: " << words << ", rounds: " << rounds << std::endl;
+
+	Report("recursive", words, rounds, [&] { return RecursiveScan(bt.get_root()); });
+	Report("cursor", words, rounds, [&] { return CursorScan(bt); });
+	Report("cursor batch", words, rounds, [&] { return BatchScan(bt); });
+}
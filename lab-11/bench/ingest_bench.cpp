@@ -0,0 +1,119 @@
+#include "ingest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Serial ProcessDirectory vs. the pipelined ingest on a cold page cache.
+// Usage: ingest_bench [documents] [kilobytes per document] [directory]
+// Pages are evicted with POSIX_FADV_DONTNEED before each run, which needs no privileges
+// but only drops clean pages; run `sync` first if the corpus was just written elsewhere.
+
+static void DropCache(const fs::path& dir_path) {
+#if defined(__unix__) && defined(POSIX_FADV_DONTNEED)
+	for (const auto& entry : fs::recursive_directory_iterator(dir_path)) {
+		if (!entry.is_regular_file())
+			continue;
+
+		int fd = ::open(entry.path().c_str(), O_RDONLY);
+		if (fd < 0)
+			continue;
+
+		::fdatasync(fd);
+		::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		::close(fd);
+	}
+#endif
+}
+
+static void MakeCorpus(const fs::path& dir_path, size_t documents, size_t kilobytes) {
+	static const char* kWords[] = { "vector", "list", "while", "for", "tree", "node", "index", "query",
+		"insert", "search", "posting", "position", "document", "term", "scheduler", "adapter" };
+
+	fs::create_directories(dir_path);
+	size_t seed = 1;
+
+	for (size_t doc_id = 1; doc_id <= documents; doc_id++) {
+		std::ofstream outfile(dir_path / (std::to_string(doc_id) + ".txt"), std::ios::out | std::ios::binary);
+		size_t written = 0;
+
+		while (written < kilobytes * 1024) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			std::string word = kWords[(seed >> 33) % 16] + std::to_string((seed >> 40) % 512);
+			outfile << word << ' ';
+			written += word.size() + 1;
+		}
+	}
+}
+
+static double ReadOnly(const fs::path& dir_path) {
+	DropCache(dir_path);
+	std::string buffer;
+
+	auto start = std::chrono::steady_clock::now();
+	for (const auto& entry : fs::recursive_directory_iterator(dir_path)) {
+		std::ifstream infile(entry.path(), std::ios::in | std::ios::binary);
+		buffer.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << "cold read only: " << elapsed.count() * 1000 << " ms" << std::endl;
+	return elapsed.count();
+}
+
+template<typename Ingest>
+static double Report(const char* name, const fs::path& dir_path, bool cold, Ingest ingest) {
+	if (cold)
+		DropCache(dir_path);
+
+	BTree bt;
+	std::map<size_t, std::string> doc_names;
+
+	auto start = std::chrono::steady_clock::now();
+	ingest(bt, doc_names);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << name << ": " << elapsed.count() * 1000 << " ms, " << doc_names.size() << " documents" << std::endl;
+	return elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+	size_t documents = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 200;
+	size_t kilobytes = argc > 2 ? std::strtoul(argv[2], NULL, 10) : 16;
+	fs::path dir_path = argc > 3 ? fs::path(argv[3]) : fs::temp_directory_path() / "ingest_bench_corpus";
+	bool generated = argc <= 3;
+
+	if (generated)
+		MakeCorpus(dir_path, documents, kilobytes);
+
+	auto serial = [&](BTree& bt, std::map<size_t, std::string>& doc_names) {
+		Parser::ProcessDirectory(dir_path, bt, doc_names);
+	};
+
+	// Overlap is the share of the shorter stage hidden behind the longer one:
+	// 1 means the pipeline costs max(read, index), 0 means it costs read + index.
+	double read = ReadOnly(dir_path);
+	double index = Report("warm serial ProcessDirectory (index only)", dir_path, false, serial);
+	Report("cold serial ProcessDirectory", dir_path, true, serial);
+
+	for (size_t readers : { 1, 2, 4 }) {
+		IngestOptions options;
+		options.readers = readers;
+		std::string name = "cold pipeline, " + std::to_string(readers) + " reader(s)";
+
+		double pipelined = Report(name.c_str(), dir_path, true, [&](BTree& bt, std::map<size_t, std::string>& doc_names) {
+			IngestPipeline::Run(dir_path, bt, doc_names, Analyzer::Default(), options);
+		});
+
+		double hidden = read + index - pipelined;
+		std::cout << "  overlap: " << 100 * std::max(0.0, std::min(hidden / std::min(read, index), 1.0)) << "%" << std::endl;
+	}
+
+	if (generated)
+		fs::remove_all(dir_path);
+}
@@ -0,0 +1,131 @@
+#include "exporter.h"
+
+#include <charconv>
+
+void Exporter::ExportJsonLines(BTree& bt, std::ostream& out, size_t chunk_records) {
+	if (chunk_records == 0)
+		chunk_records = kDefaultChunkRecords;
+
+	std::vector<std::pair<size_t, size_t>> chunks;
+	std::string body;
+	size_t offset = 0;
+	size_t records = 0;
+	size_t terms = 0;
+
+	BTreeCursor cursor(bt);
+
+	for (bool has_record = cursor.first(); has_record; has_record = cursor.next()) {
+		AppendRecord(cursor.record(), body);
+		records++;
+		terms++;
+
+		if (records == chunk_records) {
+			FlushChunk(out, body, chunks.size(), records, offset, chunks);
+			records = 0;
+		}
+	}
+
+	if (records)
+		FlushChunk(out, body, chunks.size(), records, offset, chunks);
+
+	std::string footer = "{\"terms\":";
+	AppendNumber(terms, footer);
+	footer += ",\"chunks\":[";
+	for (size_t i = 0; i < chunks.size(); i++) {
+		if (i)
+			footer += ',';
+		footer += '[';
+		AppendNumber(chunks[i].first, footer);
+		footer += ',';
+		AppendNumber(chunks[i].second, footer);
+		footer += ']';
+	}
+	footer += "]}\n";
+
+	out.write(footer.data(), footer.size());
+	out.flush();
+}
+
+void Exporter::AppendRecord(const Record& record, std::string& buffer) {
+	buffer += "{\"term\":\"";
+	AppendEscaped(*record.word, buffer);
+	buffer += "\",\"postings\":[";
+
+	for (Posting* curr_posting = record.posting_list; curr_posting; curr_posting = curr_posting->next_posting) {
+		if (curr_posting != record.posting_list)
+			buffer += ',';
+
+		buffer += '[';
+		AppendNumber(curr_posting->doc_id, buffer);
+		buffer += ',';
+		AppendNumber(curr_posting->term_frequency, buffer);
+		buffer += ",[";
+
+		for (Position* curr_pos = curr_posting->pos_info; curr_pos; curr_pos = curr_pos->next_position) {
+			if (curr_pos != curr_posting->pos_info)
+				buffer += ',';
+			AppendNumber(curr_pos->pos_num, buffer);
+		}
+
+		buffer += "]]";
+	}
+
+	buffer += "]}\n";
+}
+
+void Exporter::AppendEscaped(const std::string& word, std::string& buffer) {
+	static const char kHex[] = "0123456789abcdef";
+
+	for (unsigned char c : word) {
+		switch (c) {
+		case '"':
+			buffer += "\\\"";
+			break;
+		case '\\':
+			buffer += "\\\\";
+			break;
+		case '\n':
+			buffer += "\\n";
+			break;
+		case '\r':
+			buffer += "\\r";
+			break;
+		case '\t':
+			buffer += "\\t";
+			break;
+		default:
+			if (c < 0x20) {
+				buffer += "\\u00";
+				buffer += kHex[c >> 4];
+				buffer += kHex[c & 0xF];
+			} else {
+				buffer += static_cast<char>(c);
+			}
+		}
+	}
+}
+
+void Exporter::AppendNumber(size_t number, std::string& buffer) {
+	char digits[24];
+	auto result = std::to_chars(digits, digits + sizeof(digits), number);
+	buffer.append(digits, result.ptr);
+}
+
+void Exporter::FlushChunk(std::ostream& out, std::string& body, size_t chunk_id, size_t records,
+	size_t& offset, std::vector<std::pair<size_t, size_t>>& chunks) {
+	std::string header = "{\"chunk\":";
+	AppendNumber(chunk_id, header);
+	header += ",\"records\":";
+	AppendNumber(records, header);
+	header += ",\"bytes\":";
+	AppendNumber(body.size(), header);
+	header += "}\n";
+
+	chunks.push_back({ offset, records });
+
+	out.write(header.data(), header.size());
+	out.write(body.data(), body.size());
+
+	offset += header.size() + body.size();
+	body.clear();
+}
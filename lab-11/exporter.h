@@ -0,0 +1,32 @@
+#pragma once
+
+#include "BTree.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Chunked JSON-lines dump of the inverted index for downstream tools.
+//
+// Every chunk starts with a header line followed by exactly `records` term lines
+// occupying `bytes` bytes, so a reader can seek past chunks it does not own:
+//   {"chunk":0,"records":2,"bytes":90}
+//   {"term":"again","postings":[[2,1,[2]]]}
+//   {"term":"hello","postings":[[1,1,[1]],[2,1,[1]]]}
+// The last line is a footer with the byte offset of every chunk header, which lets
+// consumers split the file between workers without scanning it:
+//   {"terms":2,"chunks":[[0,2]]}
+// Postings are [doc_id, term_frequency, [positions...]]; terms are JSON-escaped.
+class Exporter {
+public:
+	static constexpr size_t kDefaultChunkRecords = 4096;
+
+	static void ExportJsonLines(BTree& bt, std::ostream& out, size_t chunk_records = kDefaultChunkRecords);
+
+private:
+	static void AppendRecord(const Record& record, std::string& buffer);
+	static void AppendEscaped(const std::string& word, std::string& buffer);
+	static void AppendNumber(size_t number, std::string& buffer);
+	static void FlushChunk(std::ostream& out, std::string& body, size_t chunk_id, size_t records,
+		size_t& offset, std::vector<std::pair<size_t, size_t>>& chunks);
+};
@@ -0,0 +1,147 @@
+#include "ingest.h"
+
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define INGEST_POSIX_IO 1
+#endif
+
+bool IngestPipeline::ReadFile(const fs::path& file_path, std::string& buffer) {
+#ifdef INGEST_POSIX_IO
+	int fd = ::open(file_path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (::fstat(fd, &info) != 0) {
+		::close(fd);
+		return false;
+	}
+
+#ifdef POSIX_FADV_SEQUENTIAL
+	::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+
+	// resize keeps the buffer's capacity, so a pooled buffer only grows to the largest document.
+	buffer.resize(static_cast<size_t>(info.st_size));
+	size_t filled = 0;
+
+	while (true) {
+		if (filled == buffer.size())
+			buffer.resize(buffer.size() + 4096);
+
+		ssize_t count = ::read(fd, buffer.data() + filled, buffer.size() - filled);
+		if (count < 0) {
+			::close(fd);
+			return false;
+		}
+		if (count == 0)
+			break;
+
+		filled += static_cast<size_t>(count);
+	}
+
+	buffer.resize(filled);
+	::close(fd);
+	return true;
+#else
+	std::ifstream infile(file_path, std::ios::in | std::ios::binary);
+	if (!infile)
+		return false;
+
+	buffer.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+	return true;
+#endif
+}
+
+IngestStats IngestPipeline::Run(const fs::path& dir_path, BTree& bt, std::map<size_t, std::string>& doc_names,
+	const Analyzer& analyzer, const IngestOptions& options) {
+	size_t readers = options.readers ? options.readers : 1;
+	size_t buffer_count = options.buffers > readers ? options.buffers : readers + 1;
+
+	BoundedQueue<fs::path> paths(options.queue_capacity);
+	BoundedQueue<Document> documents(buffer_count);
+	BoundedQueue<std::string*> free_buffers(buffer_count);
+
+	std::vector<std::string> buffers(buffer_count);
+	for (std::string& buffer : buffers)
+		free_buffers.push(&buffer);
+
+	std::exception_ptr enumerate_error;
+	std::mutex done_mutex;
+	size_t readers_left = readers;
+
+	std::thread enumerator([&] {
+		try {
+			for (const auto& entry : fs::recursive_directory_iterator(dir_path)) {
+				if (entry.is_regular_file() && Parser::IsDocument(entry.path()) && !paths.push(entry.path()))
+					break;
+			}
+		} catch (...) {
+			enumerate_error = std::current_exception();
+		}
+		paths.close();
+	});
+
+	std::vector<std::thread> reader_threads;
+	for (size_t i = 0; i < readers; i++) {
+		reader_threads.emplace_back([&] {
+			while (std::optional<fs::path> path = paths.pop()) {
+				std::optional<std::string*> buffer = free_buffers.pop();
+				if (!buffer)
+					break;
+
+				bool ok = ReadFile(*path, **buffer);
+				if (!documents.push(Document{ std::move(*path), *buffer, ok }))
+					break;
+			}
+
+			std::lock_guard<std::mutex> lock(done_mutex);
+			if (--readers_left == 0)
+				documents.close();
+		});
+	}
+
+	auto shutdown = [&] {
+		paths.close();
+		free_buffers.close();
+		documents.close();
+		enumerator.join();
+		for (std::thread& reader : reader_threads)
+			reader.join();
+	};
+
+	IngestStats stats;
+
+	try {
+		while (std::optional<Document> document = documents.pop()) {
+			if (document->ok) {
+				size_t doc_id = Parser::DocumentId(document->path);
+				doc_names[doc_id] = document->path.filename().string();
+				Parser::ProcessText(*document->text, doc_id, bt, analyzer);
+
+				stats.documents++;
+				stats.bytes += document->text->size();
+			} else {
+				std::cout << "Open file error!" << std::endl;
+				stats.failed++;
+			}
+
+			free_buffers.push(document->text);
+		}
+	} catch (...) {
+		shutdown();
+		throw;
+	}
+
+	shutdown();
+
+	if (enumerate_error)
+		std::rethrow_exception(enumerate_error);
+
+	return stats;
+}
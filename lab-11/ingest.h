@@ -0,0 +1,90 @@
+#pragma once
+
+#include "parser.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+
+// Fixed-capacity blocking queue connecting two pipeline stages.
+// push blocks while the queue is full; pop blocks while it is empty and returns
+// nothing once the queue is closed and drained.
+template<typename T>
+class BoundedQueue {
+private:
+	std::deque<T> items;
+	size_t capacity;
+	bool closed;
+	std::mutex mutex;
+	std::condition_variable not_full;
+	std::condition_variable not_empty;
+
+public:
+	explicit BoundedQueue(size_t a_capacity) : capacity(a_capacity ? a_capacity : 1), closed(false) {}
+
+	bool push(T item) {
+		std::unique_lock<std::mutex> lock(mutex);
+		not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+
+		if (closed)
+			return false;
+
+		items.push_back(std::move(item));
+		not_empty.notify_one();
+		return true;
+	}
+
+	std::optional<T> pop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		not_empty.wait(lock, [this] { return closed || !items.empty(); });
+
+		if (items.empty())
+			return std::nullopt;
+
+		T item = std::move(items.front());
+		items.pop_front();
+		not_full.notify_one();
+		return item;
+	}
+
+	void close() {
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+		not_full.notify_all();
+		not_empty.notify_all();
+	}
+};
+
+struct IngestOptions {
+	size_t readers = 2;
+	size_t queue_capacity = 64;
+	size_t buffers = 8;
+};
+
+struct IngestStats {
+	size_t documents = 0;
+	size_t bytes = 0;
+	size_t failed = 0;
+};
+
+// Three-stage directory ingest: one thread enumerates documents, `readers` threads
+// read them ahead into a pool of reusable buffers (hinting the kernel with
+// posix_fadvise where available), and the calling thread tokenizes and inserts,
+// since BTree is not thread-safe. Stages are joined by bounded queues, so at most
+// `buffers` documents are held in memory at once.
+class IngestPipeline {
+public:
+	static IngestStats Run(const fs::path& dir_path, BTree& bt, std::map<size_t, std::string>& doc_names,
+		const Analyzer& analyzer = Analyzer::Default(), const IngestOptions& options = IngestOptions());
+
+private:
+	struct Document {
+		fs::path path;
+		std::string* text;
+		bool ok;
+	};
+
+	static bool ReadFile(const fs::path& file_path, std::string& buffer);
+};
@@ -1,4 +1,6 @@
 #include "parser.h"
+#include "ingest.h"
+#include "exporter.h"
 
 int main(int argc, char* argv[]) {
 	BTree bt;
@@ -12,9 +14,9 @@ int main(int argc, char* argv[]) {
 
 	if (fs::is_directory(p)) {
 		std::cout << "Document Scanning..." << std::endl;
-		Parser::ProcessDirectory(path, bt, doc_names);
+		IngestPipeline::Run(p, bt, doc_names);
 		std::cout << "Inverted indexing complete!" << std::endl;
-	} else if (fs::is_regular_file(p) && p.filename().string().find("index.txt") == std::string::npos) {
+	} else if (fs::is_regular_file(p) && Parser::IsDocument(p)) {
 		Parser::ProcessFile(p, bt, doc_names);
 		std::cout << "Inverted indexing complete!" << std::endl;
 	} else {
@@ -31,6 +33,10 @@ int main(int argc, char* argv[]) {
 
 	std::cout << "Inverted file generation success!" << std::endl;
 
+	std::ofstream jsonl_file("index.jsonl", std::ios::out | std::ios::binary);
+	Exporter::ExportJsonLines(bt, jsonl_file);
+	jsonl_file.close();
+
 	std::string word;
 	Record tmp_record;
 
@@ -3,14 +3,12 @@
 namespace fs = std::filesystem;
 
 void Parser::AccessNode(PBTNode pnode, std::ofstream& outfile) {
-	size_t i;
-	for (i = 0; i < pnode->data_num; i++) {
-		std::ostringstream posting_list_str;
+	BTreeCursor cursor(pnode);
 
-		if (pnode->child[i])
-			AccessNode(pnode->child[i], outfile);
+	for (bool has_record = cursor.first(); has_record; has_record = cursor.next()) {
+		std::ostringstream posting_list_str;
 
-		Posting* curr_posting = pnode->data[i].posting_list;
+		Posting* curr_posting = cursor.record().posting_list;
 		Position* curr_pos;
 
 		while (curr_posting) {
@@ -30,94 +28,83 @@ void Parser::AccessNode(PBTNode pnode, std::ofstream& outfile) {
 			curr_posting = curr_posting->next_posting;
 		}
 
-		outfile << std::setiosflags(std::ios::left) << std::setw(20) << *pnode->data[i].word << posting_list_str.str() << std::endl;
+		outfile << std::setiosflags(std::ios::left) << std::setw(20) << *cursor.record().word << posting_list_str.str() << std::endl;
 	}
-
-	if (pnode->child[i])
-		AccessNode(pnode->child[i], outfile);
 }
 
-void Parser::ProcessDirectory(const fs::path& dir_path, BTree& bt, std::map<size_t, std::string>& doc_names) {
+void Parser::ProcessDirectory(const fs::path& dir_path, BTree& bt, std::map<size_t, std::string>& doc_names, const Analyzer& analyzer) {
 
 	for (const auto& entry : fs::directory_iterator(dir_path)) {
 		if (entry.is_directory()) {
-			ProcessDirectory(entry.path(), bt, doc_names);
+			ProcessDirectory(entry.path(), bt, doc_names, analyzer);
 		}
-		else if (entry.is_regular_file() && entry.path().filename().string().find("index.txt") == std::string::npos) {
-			std::ifstream infile(entry.path(), std::ios::in);
-			if (!infile) {
-				std::cout << "Open file error!" << std::endl;
-				continue;
-			}
-
-			size_t doc_id = std::stoul(entry.path().filename().string().substr(0, entry.path().filename().string().find('.')));
-			doc_names[doc_id] = entry.path().filename().string();
-			size_t word_counter = 1;
-			while (true) {
-				std::string* word = new std::string();
-
-				if (!(infile >> *word)) {
-					delete word;
-					break;
-				}
-
-				for (size_t i = 0; i < word->size(); i++) {
-					if ((*word)[i] >= 'A' && (*word)[i] <= 'Z') {
-						(*word)[i] += 32;
-					}
-				}
-
-				bt.insert(word, doc_id, word_counter);
-
-				word_counter++;
-			}
-
-			infile.close();
+		else if (entry.is_regular_file() && IsDocument(entry.path())) {
+			ProcessFile(entry.path(), bt, doc_names, analyzer);
 		}
 	}
 }
 
-void Parser::ProcessFile(const fs::path& file_path, BTree& bt, std::map<size_t, std::string>& doc_names) {
-	std::ifstream infile(file_path, std::ios::in);
+void Parser::ProcessFile(const fs::path& file_path, BTree& bt, std::map<size_t, std::string>& doc_names, const Analyzer& analyzer) {
+	std::ifstream infile(file_path, std::ios::in | std::ios::binary);
 	if (!infile) {
 		std::cout << "Open file error!" << std::endl;
 		return;
 	}
 
-	size_t doc_id = std::stoul(file_path.filename().string().substr(0, file_path.filename().string().find('.')));
+	size_t doc_id = DocumentId(file_path);
 	doc_names[doc_id] = file_path.filename().string();
-	size_t word_counter = 1;
 
-	while (true) {
-		std::string* word = new std::string();
+	std::string text((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+	infile.close();
 
-		if (!(infile >> *word)) {
-			delete word;
-			break;
-		}
+	ProcessText(text, doc_id, bt, analyzer);
+}
 
-		for (size_t i = 0; i < word->size(); i++) {
-			if ((*word)[i] >= 'A' && (*word)[i] <= 'Z') {
-				(*word)[i] += 32;
-			}
-		}
+void Parser::ProcessText(std::string_view text, size_t doc_id, BTree& bt, const Analyzer& analyzer) {
+	analyzer.analyze(text, [&bt, doc_id](std::string& token, size_t word_counter) {
+		bt.insert(new std::string(std::move(token)), doc_id, word_counter);
+	});
+}
 
-		bt.insert(word, doc_id, word_counter);
-		word_counter++;
-	}
+size_t Parser::DocumentId(const fs::path& file_path) {
+	std::string file_name = file_path.filename().string();
+	return std::stoul(file_name.substr(0, file_name.find('.')));
+}
 
-	infile.close();
+bool Parser::IsDocument(const fs::path& file_path) {
+	return file_path.filename().string().find("index.txt") == std::string::npos;
 }
 
-std::vector<std::string> Parser::tokenize(const std::string& query) {
+std::vector<std::string> Parser::tokenize(const std::string& query, const Analyzer& analyzer) {
 	std::vector<std::string> tokens;
 	std::stringstream ss(query);
 	std::string token;
 
 	while (std::getline(ss, token, ' ')) {
-		if (!token.empty()) {
-			tokens.push_back(token);
+		size_t begin = 0;
+		size_t end = token.size();
+
+		while (begin < end && token[begin] == '(') {
+			tokens.push_back("(");
+			begin++;
+		}
+
+		size_t closing = 0;
+		while (end > begin && token[end - 1] == ')') {
+			closing++;
+			end--;
 		}
+
+		std::string_view term(token.data() + begin, end - begin);
+
+		if (term == "AND" || term == "OR") {
+			tokens.emplace_back(term);
+		} else if (!term.empty()) {
+			for (std::string& word : analyzer.analyze(term))
+				tokens.push_back(std::move(word));
+		}
+
+		tokens.insert(tokens.end(), closing, ")");
 	}
 
 	return tokens;
@@ -152,6 +139,9 @@ std::vector<size_t> Parser::evaluate_boolean_query(const std::vector<std::string
 				posting_doc_ids.push_back(curr_posting->doc_id);
 				curr_posting = curr_posting->next_posting;
 			}
+			// Postings are kept in insertion order, which the parallel ingest
+			// pipeline does not fix; the set operations below need sorted ids.
+			std::sort(posting_doc_ids.begin(), posting_doc_ids.end());
 
 			if (i == 0 || (tokens[i - 1] != "AND" && tokens[i - 1] != "OR")) {
 				for (auto& c : posting_doc_ids)
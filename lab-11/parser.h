@@ -1,6 +1,7 @@
 #pragma once
 
 #include "BTree.h"
+#include "analyzer.h"
 
 #include <iostream>
 #include <fstream>
@@ -15,9 +16,12 @@ namespace fs = std::filesystem;
 class Parser {
 public:
 	static void AccessNode(PBTNode pnode, std::ofstream& outfile);
-	static void ProcessDirectory(const fs::path& dir_path, BTree& bt, std::map<size_t, std::string>& doc_names);
-	static void ProcessFile(const fs::path& file_path, BTree& bt, std::map<size_t, std::string>& doc_names);
-	static std::vector<std::string> tokenize(const std::string& query);
+	static void ProcessDirectory(const fs::path& dir_path, BTree& bt, std::map<size_t, std::string>& doc_names, const Analyzer& analyzer = Analyzer::Default());
+	static void ProcessFile(const fs::path& file_path, BTree& bt, std::map<size_t, std::string>& doc_names, const Analyzer& analyzer = Analyzer::Default());
+	static void ProcessText(std::string_view text, size_t doc_id, BTree& bt, const Analyzer& analyzer = Analyzer::Default());
+	static size_t DocumentId(const fs::path& file_path);
+	static bool IsDocument(const fs::path& file_path);
+	static std::vector<std::string> tokenize(const std::string& query, const Analyzer& analyzer = Analyzer::Default());
 	static std::vector<size_t> evaluate_boolean_query(const std::vector<std::string>& tokens, BTree& bt);
 	static void process_user_query(BTree& bt, const std::map<size_t, std::string>& doc_names);
 };
\ No newline at end of file
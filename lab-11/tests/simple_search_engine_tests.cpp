@@ -2,7 +2,9 @@
 #include <filesystem>
 #include <fstream>
 #include "parser.h"
-#include "btree.h"
+#include "BTree.h"
+#include "exporter.h"
+#include "ingest.h"
 
 namespace fs = std::filesystem;
 
@@ -151,4 +153,266 @@ TEST(ParserTest, ProcessUserQuery) {
 
     remove_temp_file("1.txt");
     remove_temp_file("2.txt");
-}
\ No newline at end of file
+}
+
+// Test for ExportJsonLines: records are ordered and every chunk is addressable
+TEST(ExporterTest, ExportJsonLinesChunks) {
+    BTree bt;
+    std::map<size_t, std::string> doc_names;
+
+    create_temp_file("1.txt", "hello world");
+    create_temp_file("2.txt", "hello again");
+
+    Parser::ProcessFile("1.txt", bt, doc_names);
+    Parser::ProcessFile("2.txt", bt, doc_names);
+
+    std::ostringstream out;
+    Exporter::ExportJsonLines(bt, out, 2);
+    std::string dump = out.str();
+
+    ASSERT_EQ(dump,
+        "{\"chunk\":0,\"records\":2,\"bytes\":90}\n"
+        "{\"term\":\"again\",\"postings\":[[2,1,[2]]]}\n"
+        "{\"term\":\"hello\",\"postings\":[[1,1,[1]],[2,1,[1]]]}\n"
+        "{\"chunk\":1,\"records\":1,\"bytes\":40}\n"
+        "{\"term\":\"world\",\"postings\":[[1,1,[2]]]}\n"
+        "{\"terms\":3,\"chunks\":[[0,2],[125,1]]}\n");
+
+    ASSERT_EQ(dump.compare(125, 10, "{\"chunk\":1"), 0);
+
+    remove_temp_file("1.txt");
+    remove_temp_file("2.txt");
+}
+
+// Test for ExportJsonLines: terms longer than the text column and special characters
+TEST(ExporterTest, ExportJsonLinesEscaping) {
+    BTree bt;
+    bt.insert(new std::string("a\"quoted\\term-that-is-longer-than-twenty"), 1, 1);
+
+    std::ostringstream out;
+    Exporter::ExportJsonLines(bt, out);
+
+    std::istringstream in(out.str());
+    std::string line;
+    ASSERT_TRUE(std::getline(in, line));
+    ASSERT_TRUE(std::getline(in, line));
+    ASSERT_EQ(line, "{\"term\":\"a\\\"quoted\\\\term-that-is-longer-than-twenty\",\"postings\":[[1,1,[1]]]}");
+}
+
+// Helper function to fill a tree with enough distinct words to get several levels
+std::vector<std::string> fill_tree(BTree& bt, size_t count) {
+    std::vector<std::string> words;
+    for (size_t i = 0; i < count; i++) {
+        std::string word = "w" + std::to_string((i * 7919) % count);
+        words.push_back(word);
+        bt.insert(new std::string(word), 1, i + 1);
+    }
+    std::sort(words.begin(), words.end());
+    return words;
+}
+
+// Test for BTreeCursor: forward and backward scans visit every word in order
+TEST(BTreeCursorTest, ForwardAndBackward) {
+    BTree bt;
+    std::vector<std::string> words = fill_tree(bt, 10000);
+
+    BTreeCursor cursor(bt);
+    std::vector<std::string> forward;
+    for (bool has_record = cursor.first(); has_record; has_record = cursor.next())
+        forward.push_back(*cursor.record().word);
+    ASSERT_EQ(forward, words);
+    ASSERT_FALSE(cursor.next());
+
+    std::vector<std::string> backward;
+    for (bool has_record = cursor.last(); has_record; has_record = cursor.prev())
+        backward.push_back(*cursor.record().word);
+    std::reverse(backward.begin(), backward.end());
+    ASSERT_EQ(backward, words);
+}
+
+// Test for BTreeCursor::seek: exact hits, gaps and the end of the tree
+TEST(BTreeCursorTest, Seek) {
+    BTree bt;
+    std::vector<std::string> words = fill_tree(bt, 10000);
+    BTreeCursor cursor(bt);
+
+    for (size_t i = 0; i < words.size(); i += 37) {
+        ASSERT_TRUE(cursor.seek(words[i]));
+        ASSERT_EQ(*cursor.record().word, words[i]);
+
+        ASSERT_TRUE(cursor.seek(words[i] + "0"));
+        if (i + 1 < words.size())
+            ASSERT_EQ(*cursor.record().word, words[i + 1]);
+
+        ASSERT_TRUE(cursor.prev());
+        ASSERT_EQ(*cursor.record().word, words[i]);
+    }
+
+    ASSERT_FALSE(cursor.seek("x"));
+    ASSERT_TRUE(cursor.seek(""));
+    ASSERT_EQ(*cursor.record().word, words.front());
+
+    BTree empty;
+    BTreeCursor empty_cursor(empty);
+    ASSERT_FALSE(empty_cursor.first());
+    ASSERT_FALSE(empty_cursor.seek("a"));
+}
+
+// Test for BTreeCursor::next_batch: batches cover the tree without gaps or repeats
+TEST(BTreeCursorTest, NextBatch) {
+    BTree bt;
+    std::vector<std::string> words = fill_tree(bt, 10000);
+    BTreeCursor cursor(bt);
+    Record* batch[64];
+
+    std::vector<std::string> scanned;
+    cursor.first();
+    while (size_t count = cursor.next_batch(batch, 64)) {
+        for (size_t i = 0; i < count; i++)
+            scanned.push_back(*batch[i]->word);
+    }
+    ASSERT_EQ(scanned, words);
+}
+
+// Test for Analyzer: punctuation splits terms and case folding is UTF-8 aware
+TEST(AnalyzerTest, SplitAndFold) {
+    std::vector<std::string> expected = { "data", "data", "std", "vector", "size_t", "привет", "ёлка", "straße", "déjà", "αβγ" };
+    ASSERT_EQ(Analyzer::Default().analyze("Data, DATA std::vector<size_t> Привет! «Ёлка» STRAßE DÉJÀ ΑΒΓ"), expected);
+}
+
+// Test for Analyzer: dotted capital 'İ' folds to a plain 'i'
+TEST(AnalyzerTest, FoldDottedCapitalI) {
+    std::vector<std::string> expected = { "istanbul", "istanbul", "ıi" };
+    ASSERT_EQ(Analyzer::Default().analyze("İSTANBUL istanbul ıİ"), expected);
+}
+
+// Test for Analyzer: the SSE2 block path and the scalar tail agree across block boundaries
+TEST(AnalyzerTest, LongAsciiInput) {
+    std::string text;
+    std::vector<std::string> expected;
+    for (size_t i = 0; i < 200; i++) {
+        std::string word(i % 23 + 1, static_cast<char>('A' + i % 26));
+        text += word + (i % 3 ? ", " : "\n");
+        std::transform(word.begin(), word.end(), word.begin(), [](char c) { return c + 32; });
+        expected.push_back(word);
+    }
+    ASSERT_EQ(Analyzer::Default().analyze(text), expected);
+}
+
+// Test for Analyzer filters: stop words are dropped but still take a position
+TEST(AnalyzerTest, Filters) {
+    Analyzer analyzer;
+    analyzer.add_filter(std::make_unique<StopWordFilter>()).add_filter(std::make_unique<PluralStemmer>());
+
+    std::vector<std::pair<std::string, size_t>> tokens;
+    analyzer.analyze("The queries of boxes and cats", [&tokens](std::string& token, size_t position) {
+        tokens.push_back({ token, position });
+    });
+
+    std::vector<std::pair<std::string, size_t>> expected = { { "query", 2 }, { "boxe", 4 }, { "cat", 6 } };
+    ASSERT_EQ(tokens, expected);
+}
+
+// Test for tokenize: operators and parentheses survive, terms go through the analyzer
+TEST(ParserTest, TokenizeQuerySyntax) {
+    std::vector<std::string> expected = { "(", "while", "OR", "for", ")", "AND", "vector" };
+    ASSERT_EQ(Parser::tokenize("(While OR for) AND Vector,"), expected);
+}
+
+// Test for ProcessFile: punctuation does not create separate dictionary entries
+TEST(ParserTest, ProcessFilePunctuation) {
+    BTree bt;
+    std::map<size_t, std::string> doc_names;
+
+    create_temp_file("1.txt", "data, Data. (data)");
+    Parser::ProcessFile("1.txt", bt, doc_names);
+
+    std::string word = "data";
+    Record record;
+    record.word = &word;
+    ASSERT_TRUE(bt.search(record));
+    ASSERT_EQ(record.posting_list->term_frequency, 3);
+
+    remove_temp_file("1.txt");
+}
+
+// Test for IngestPipeline: builds the same index as the serial ProcessDirectory
+TEST(IngestPipelineTest, MatchesProcessDirectory) {
+    fs::create_directories("ingestdir/nested");
+    for (size_t i = 1; i <= 40; i++) {
+        std::string path = (i % 2 ? "ingestdir/" : "ingestdir/nested/") + std::to_string(i) + ".txt";
+        create_temp_file(path, "Hello world, document " + std::to_string(i % 7) + " again");
+    }
+
+    BTree serial_bt;
+    std::map<size_t, std::string> serial_names;
+    Parser::ProcessDirectory(fs::path("ingestdir"), serial_bt, serial_names);
+
+    BTree pipeline_bt;
+    std::map<size_t, std::string> pipeline_names;
+    IngestOptions options;
+    options.readers = 3;
+    options.queue_capacity = 2;
+    options.buffers = 4;
+    IngestStats stats = IngestPipeline::Run(fs::path("ingestdir"), pipeline_bt, pipeline_names, Analyzer::Default(), options);
+
+    ASSERT_EQ(stats.documents, 40);
+    ASSERT_EQ(stats.failed, 0);
+    ASSERT_EQ(pipeline_names, serial_names);
+
+    BTreeCursor serial_cursor(serial_bt);
+    BTreeCursor pipeline_cursor(pipeline_bt);
+    bool serial_has = serial_cursor.first();
+    bool pipeline_has = pipeline_cursor.first();
+    while (serial_has && pipeline_has) {
+        ASSERT_EQ(*serial_cursor.record().word, *pipeline_cursor.record().word);
+
+        size_t serial_docs = 0;
+        for (Posting* p = serial_cursor.record().posting_list; p; p = p->next_posting)
+            serial_docs++;
+        size_t pipeline_docs = 0;
+        for (Posting* p = pipeline_cursor.record().posting_list; p; p = p->next_posting)
+            pipeline_docs++;
+        ASSERT_EQ(serial_docs, pipeline_docs);
+
+        serial_has = serial_cursor.next();
+        pipeline_has = pipeline_cursor.next();
+    }
+    ASSERT_EQ(serial_has, pipeline_has);
+
+    fs::remove_all("ingestdir");
+}
+
+// Test for evaluate_boolean_query over a pipeline-built index, whose posting lists are not in doc id order
+TEST(IngestPipelineTest, BooleanQueryOverPipelineIndex) {
+    fs::create_directories("ingestquerydir");
+    std::vector<size_t> expected_and;
+    std::vector<size_t> expected_or;
+    for (size_t i = 1; i <= 60; i++) {
+        std::string text = "filler";
+        if (i % 2 == 0)
+            text += " alpha";
+        if (i % 3 == 0)
+            text += " beta";
+        if (i % 6 == 0)
+            expected_and.push_back(i);
+        if (i % 2 == 0 || i % 3 == 0)
+            expected_or.push_back(i);
+        create_temp_file("ingestquerydir/" + std::to_string(i) + ".txt", text);
+    }
+
+    for (int run = 0; run < 5; run++) {
+        BTree bt;
+        std::map<size_t, std::string> doc_names;
+        IngestOptions options;
+        options.readers = 4;
+        options.queue_capacity = 2;
+        options.buffers = 4;
+        IngestPipeline::Run(fs::path("ingestquerydir"), bt, doc_names, Analyzer::Default(), options);
+
+        ASSERT_EQ(Parser::evaluate_boolean_query(Parser::tokenize("alpha AND beta"), bt), expected_and);
+        ASSERT_EQ(Parser::evaluate_boolean_query(Parser::tokenize("alpha OR beta"), bt), expected_or);
+    }
+
+    fs::remove_all("ingestquerydir");
+}
@@ -1,673 +1,2501 @@
 #pragma once
-#include <iterator>
-#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <initializer_list>
-#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
 #include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#endif
+
+// Adapters are lazy views: piping a container into one stores a reference to it, and
+// every further stage stores the stage before it plus its own argument, never the
+// elements. Building a pipeline therefore costs the same for ten elements as for ten
+// million, and the work happens only while iterating. A temporary container is moved
+// into the first stage so that it lives as long as the pipeline; a named one must
+// outlive every view made from it.
+//
+// Besides iterators, every view can push its elements into a sink: push(sink) calls
+// sink(element) for each element, where each stage wraps the sink of the next one
+// (transform applies its function, filter tests its condition, take counts) around
+// the loop of the source container. A whole chain thus inlines into one loop that
+// evaluates every function and condition once per element, and, if the sink never
+// stops early, into a counted loop the compiler can vectorize. The terminal
+// operations at the end (for_each, reduce, collect, count) run pipelines this way;
+// range-for uses the iterators.
+
+namespace detail {
+	// Base of every view, so that piping a view copies it (it is small) while piping
+	// a container refers to it.
+	struct view_base {};
+
+	template<typename Range>
+	using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<Range>>;
+
+	template<typename Range>
+	constexpr bool is_view_v = std::is_base_of<view_base, remove_cvref_t<Range>>::value;
+
+	template<typename Range>
+	using iterator_t = decltype(std::begin(std::declval<Range&>()));
+
+	template<typename Range>
+	using range_value_t = typename std::iterator_traits<iterator_t<Range>>::value_type;
+
+	template<typename Iterator, typename Category>
+	constexpr bool is_at_least_v = std::is_base_of<Category, typename std::iterator_traits<Iterator>::iterator_category>::value;
+
+	// The category of Iterator, capped at Strongest: an adapter's iterator is as strong
+	// as the one it wraps, up to what the adapter can support.
+	template<typename Iterator, typename Strongest>
+	using category_t = std::conditional_t<is_at_least_v<Iterator, Strongest>, Strongest,
+		typename std::iterator_traits<Iterator>::iterator_category>;
+
+	template<typename Range>
+	constexpr bool is_random_access_v = is_at_least_v<iterator_t<const Range>, std::random_access_iterator_tag>;
+
+	template<typename Range, typename = void>
+	struct is_sized : std::false_type {};
+
+	template<typename Range>
+	struct is_sized<Range, std::void_t<decltype(std::declval<const Range&>().size())>> : std::true_type {};
+
+	template<typename Range>
+	constexpr bool is_sized_v = is_sized<Range>::value;
+
+	// Views whose elements can be pushed by position in their source, in slices
+	// [from, to) of [0, slice_size()), which parallel terminal operations hand out to
+	// threads. Random access views slice themselves; transform and filter slice their
+	// base and pass on what falls into the slice.
+	template<typename Range, typename = void>
+	struct is_sliceable : std::false_type {};
+
+	template<typename Range>
+	struct is_sliceable<Range, std::void_t<decltype(std::declval<const Range&>().slice_size())>> : std::true_type {};
+
+	template<typename Range>
+	constexpr bool is_sliceable_v = is_sliceable<Range>::value;
+
+	// Sliceable views of arithmetic elements that can also push a slice a block at a
+	// time, as block(const T* data, size_t n) calls of at most block_size elements: a
+	// contiguous container hands out its own memory, transform maps a block into a
+	// buffer on the stack, filter tests a whole block and then compacts it without
+	// branches. These loops are counted and branch-free, so the compiler vectorizes
+	// them; collect materializes such pipelines this way.
+	constexpr size_t block_size = 256;
+
+	template<typename Container, typename = void>
+	struct is_contiguous_arithmetic : std::false_type {};
 
-namespace drop {
-	struct drop_helper {
-		size_t helper;
-		drop_helper(size_t d) : helper(d) {}
+	template<typename Container>
+	struct is_contiguous_arithmetic<Container, std::void_t<decltype(std::data(std::declval<Container&>()))>>
+		: std::is_arithmetic<std::remove_pointer_t<decltype(std::data(std::declval<Container&>()))>> {};
+
+	struct block_probe {
+		template<typename T>
+		void operator()(const T*, size_t) const {}
 	};
 
-	template <typename Container>
-	struct dropped_range {
-		using iterator = typename Range::iterator;
-		iterator begin_;
-		Container container;
+	template<typename Range, typename = void>
+	struct is_blocked : std::false_type {};
+
+	template<typename Range>
+	struct is_blocked<Range, std::void_t<decltype(std::declval<const Range&>().push_blocks(size_t(), size_t(), block_probe()))>>
+		: std::true_type {};
+
+	template<typename Range>
+	constexpr bool is_blocked_v = is_blocked<Range>::value;
+
+	// Block kernels pass elements as const, so a stage over blocks needs a function
+	// that accepts them that way; one taking T& runs element by element.
+	template<typename Function, typename Range>
+	constexpr bool is_block_invocable_v = std::is_invocable<const Function&, const range_value_t<const Range>&>::value;
+
+	// Copies the data[i] with keep[i] set to out, in order, and returns how many.
+	// With AVX-512, 4- and 8-byte elements are moved by compress-stores a vector at a
+	// time; otherwise, and for the rest, every element is stored and the output is
+	// advanced past the kept ones, which needs no branches.
+	template<typename T>
+	size_t compact(const T* data, const unsigned char* keep, size_t n, T* out) {
+		size_t count = 0;
+		size_t i = 0;
+#if defined(__AVX512F__)
+		const __m128i zero = _mm_setzero_si128();
+		if constexpr (sizeof(T) == 4) {
+			for (; i + 16 <= n; i += 16) {
+				__m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keep + i));
+				auto mask = static_cast<__mmask16>(_mm_movemask_epi8(_mm_cmpgt_epi8(flags, zero)));
+				_mm512_mask_compressstoreu_epi32(out + count, mask, _mm512_loadu_si512(data + i));
+				count += std::bitset<16>(mask).count();
+			}
+		} else if constexpr (sizeof(T) == 8) {
+			for (; i + 8 <= n; i += 8) {
+				__m128i flags = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(keep + i));
+				auto mask = static_cast<__mmask8>(_mm_movemask_epi8(_mm_cmpgt_epi8(flags, zero)));
+				_mm512_mask_compressstoreu_epi64(out + count, mask, _mm512_loadu_si512(data + i));
+				count += std::bitset<8>(mask).count();
+			}
+		}
+#endif
+		for (; i < n; ++i) {
+			out[count] = data[i];
+			count += keep[i];
+		}
+		return count;
+	}
+
+	template<typename Data, typename Block>
+	void push_data_blocks(const Data* data, size_t from, size_t to, Block& block) {
+		for (size_t i = from; i < to; i += block_size) {
+			block(data + i, std::min(block_size, to - i));
+		}
+	}
+
+	// Calls sink(value) and tells whether to go on: a sink may return false to stop,
+	// one that returns nothing never does.
+	template<typename Sink, typename Value>
+	bool feed(Sink& sink, Value&& value) {
+		if constexpr (std::is_void<decltype(sink(std::forward<Value>(value)))>::value) {
+			sink(std::forward<Value>(value));
+			return true;
+		} else {
+			return sink(std::forward<Value>(value));
+		}
+	}
 
-		dropped_range(Container& c, size_t amount) : container(c) {
-			begin_ = c.begin();
-			for (size_t i = 0; i < amount; ++i) {
-				begin_++;
+	// Pushes [first, last) into sink; false if the sink stopped the loop.
+	template<typename Iterator, typename Sink>
+	bool push_iterators(Iterator first, Iterator last, Sink& sink) {
+		if constexpr (is_at_least_v<Iterator, std::random_access_iterator_tag>) {
+			std::ptrdiff_t size = last - first;
+			for (std::ptrdiff_t i = 0; i < size; ++i) {
+				if (!feed(sink, first[i])) {
+					return false;
+				}
+			}
+		} else {
+			for (; first != last; ++first) {
+				if (!feed(sink, *first)) {
+					return false;
+				}
 			}
 		}
+		return true;
+	}
 
-		template<typename Iter> class drop_iterator {
-			using iterator_category = std::forward_iterator_tag;
+	template<typename Container>
+	struct ref_view : view_base {
+		Container* container_;
+
+		explicit ref_view(Container& c) : container_(&c) {}
+
+		auto begin() const {
+			return std::begin(*container_);
+		}
+
+		auto end() const {
+			return std::end(*container_);
+		}
+
+		template<typename C = Container, typename = std::enable_if_t<is_sized_v<C>>>
+		size_t size() const {
+			return container_->size();
+		}
+
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			return push_iterators(begin(), end(), sink);
+		}
+
+		template<typename C = Container, typename = std::enable_if_t<is_random_access_v<C>>>
+		size_t slice_size() const {
+			return size_t(end() - begin());
+		}
+
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return push_iterators(begin() + std::ptrdiff_t(from), begin() + std::ptrdiff_t(to), sink);
+		}
+
+		template<typename Block, typename C = Container, typename = std::enable_if_t<is_contiguous_arithmetic<C>::value>>
+		void push_blocks(size_t from, size_t to, Block&& block) const {
+			push_data_blocks(std::data(*container_), from, to, block);
+		}
+	};
+
+	template<typename Container>
+	struct owning_view : view_base {
+		Container container_;
+
+		explicit owning_view(Container&& c) : container_(std::move(c)) {}
+
+		auto begin() const {
+			return std::begin(container_);
+		}
+
+		auto end() const {
+			return std::end(container_);
+		}
+
+		template<typename C = Container, typename = std::enable_if_t<is_sized_v<C>>>
+		size_t size() const {
+			return container_.size();
+		}
+
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			return push_iterators(begin(), end(), sink);
+		}
+
+		template<typename C = Container, typename = std::enable_if_t<is_random_access_v<C>>>
+		size_t slice_size() const {
+			return size_t(end() - begin());
+		}
+
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return push_iterators(begin() + std::ptrdiff_t(from), begin() + std::ptrdiff_t(to), sink);
+		}
+
+		template<typename Block, typename C = Container, typename = std::enable_if_t<is_contiguous_arithmetic<C>::value>>
+		void push_blocks(size_t from, size_t to, Block&& block) const {
+			push_data_blocks(std::data(container_), from, to, block);
+		}
+	};
+
+	// What a stage stores of the range piped into it.
+	template<typename Range>
+	auto all(Range&& range) {
+		if constexpr (is_view_v<Range>) {
+			return remove_cvref_t<Range>(std::forward<Range>(range));
+		} else if constexpr (std::is_lvalue_reference<Range>::value) {
+			return ref_view<std::remove_reference_t<Range>>(range);
+		} else {
+			return owning_view<remove_cvref_t<Range>>(std::move(range));
+		}
+	}
+
+	template<typename Range>
+	using all_t = decltype(all(std::declval<Range>()));
+
+	template<typename Range, typename Sink>
+	bool push(const Range& range, Sink&& sink) {
+		if constexpr (is_view_v<Range>) {
+			return range.push(sink);
+		} else {
+			return push_iterators(std::begin(range), std::end(range), sink);
+		}
+	}
+
+	// it advanced by n, or to end if that comes first.
+	template<typename Iterator>
+	Iterator advance_bounded(Iterator it, size_t n, const Iterator& end) {
+		if constexpr (is_at_least_v<Iterator, std::random_access_iterator_tag>) {
+			return it + std::min<std::ptrdiff_t>(static_cast<std::ptrdiff_t>(n), end - it);
+		} else {
+			for (; n > 0 && it != end; --n) {
+				++it;
+			}
+			return it;
+		}
+	}
+
+	template<typename Value, typename = void>
+	struct is_pair_like : std::false_type {};
+
+	template<typename Value>
+	struct is_pair_like<Value, std::void_t<decltype(std::declval<Value&>().first), decltype(std::declval<Value&>().second)>>
+		: std::true_type {};
+} // namespace detail
+
+
+
+
+
+
+
+// Sources: views that produce their elements while being iterated instead of referring
+// to a container, and plug into pipelines like one. A pipeline over a source holds only
+// the element in flight, so it runs in constant memory however long the input is.
+
+namespace lines {
+	// The lines of a text file without their '\n', read one at a time while iterating.
+	// Every pass opens the file anew; copies of an iterator share its stream, so the
+	// iterators are input iterators.
+	struct lines_range : detail::view_base {
+		struct stream {
+			std::ifstream file;
+			std::string line;
+		};
+
+		// Null at the end of the file.
+		struct lines_iterator {
+			using iterator_category = std::input_iterator_tag;
 			using difference_type = std::ptrdiff_t;
-			using value_type = typename Container::value_type;
-			using pointer = value_type*;
-			using reference = value_type&;
+			using value_type = std::string;
+			using pointer = const std::string*;
+			using reference = const std::string&;
+
+			std::shared_ptr<stream> stream_;
 
-			drop_iterator this_iter;
-			drop_iterator(const drop_iterator& other_iter) : this_iter(other_iter) {}
+			lines_iterator() = default;
+			explicit lines_iterator(std::shared_ptr<stream> s) : stream_(std::move(s)) {
+				++(*this);
+			}
 
-			drop_iterator& operator++() {
-				this_iter++;
+			lines_iterator& operator++() {
+				if (!std::getline(stream_->file, stream_->line)) {
+					stream_.reset();
+				}
 				return *this;
 			}
 
-			drop_iterator& operator++(int) {
-				drop_iterator tmp(*this);
-				++begin_;
-				return tmp;
+			void operator++(int) {
+				++(*this);
 			}
 
-			value_type operator*() {
-				return *this_iter;
+			reference operator*() const {
+				return stream_->line;
 			}
 
 			pointer operator->() const {
-				return std::addressof(operator*());
+				return &stream_->line;
+			}
+
+			bool operator==(const lines_iterator& other) const {
+				return stream_ == other.stream_;
+			}
+
+			bool operator!=(const lines_iterator& other) const {
+				return !(*this == other);
+			}
+		};
+
+		using iterator = lines_iterator;
+
+		std::string path_;
+
+		explicit lines_range(std::string path) : path_(std::move(path)) {}
+
+		iterator begin() const {
+			return iterator(open());
+		}
+
+		iterator end() const {
+			return iterator();
+		}
+
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			std::shared_ptr<stream> s = open();
+			const std::string& line = s->line;
+			while (std::getline(s->file, s->line)) {
+				if (!detail::feed(sink, line)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		std::shared_ptr<stream> open() const {
+			auto s = std::make_shared<stream>();
+			s->file.open(path_);
+			if (!s->file) {
+				throw std::runtime_error("cannot open " + path_);
+			}
+			return s;
+		}
+	};
+
+	inline lines_range lines(std::string path) {
+		return lines_range(std::move(path));
+	}
+} // namespace lines
+
+
+
+
+
+
+
+#if __has_include(<sys/mman.h>)
+namespace bytes {
+	// The bytes of a file, mapped into memory instead of read. The range is contiguous,
+	// so it is random access, sliceable and blocked like a vector of char, while the
+	// kernel pages the file in as it is touched and may evict what has been passed;
+	// a file larger than memory can thus be scanned too. Copies share the mapping,
+	// which is removed with the last of them.
+	struct bytes_range : detail::view_base {
+		struct mapping {
+			const char* data = nullptr;
+			size_t size = 0;
+
+			explicit mapping(const std::string& path) {
+				int fd = ::open(path.c_str(), O_RDONLY);
+				if (fd < 0) {
+					throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+				}
+				struct stat info;
+				if (::fstat(fd, &info) != 0) {
+					fail(fd, path);
+				}
+				size = size_t(info.st_size);
+				if (size != 0) {
+					void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (address == MAP_FAILED) {
+						fail(fd, path);
+					}
+					::madvise(address, size, MADV_SEQUENTIAL);
+					data = static_cast<const char*>(address);
+				}
+				::close(fd);
+			}
+
+			mapping(const mapping&) = delete;
+			mapping& operator=(const mapping&) = delete;
+
+			~mapping() {
+				if (data != nullptr) {
+					::munmap(const_cast<char*>(data), size);
+				}
+			}
+
+			[[noreturn]] static void fail(int fd, const std::string& path) {
+				int error = errno;
+				::close(fd);
+				throw std::system_error(error, std::generic_category(), "cannot map " + path);
+			}
+		};
+
+		using iterator = const char*;
+
+		std::shared_ptr<const mapping> mapping_;
+
+		explicit bytes_range(const std::string& path) : mapping_(std::make_shared<const mapping>(path)) {}
+
+		iterator begin() const {
+			return mapping_->data;
+		}
+
+		iterator end() const {
+			return mapping_->data + mapping_->size;
+		}
+
+		size_t size() const {
+			return mapping_->size;
+		}
+
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			return detail::push_iterators(begin(), end(), sink);
+		}
+
+		size_t slice_size() const {
+			return mapping_->size;
+		}
+
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return detail::push_iterators(begin() + from, begin() + to, sink);
+		}
+
+		template<typename Block>
+		void push_blocks(size_t from, size_t to, Block&& block) const {
+			detail::push_data_blocks(mapping_->data, from, to, block);
+		}
+	};
+
+	inline bytes_range bytes(const std::string& path) {
+		return bytes_range(path);
+	}
+} // namespace bytes
+#endif
+
+
+
+
+
+
+
+namespace iota {
+	// The integers from first up to, not including, last, computed as they are read.
+	// Random access, sized and blocked like a vector of them.
+	template<typename T>
+	struct iota_range : detail::view_base {
+		static_assert(std::is_integral<T>::value, "iota() needs an integral type");
+
+		// Differences are taken in the unsigned type, so they are right for any two values
+		// at most PTRDIFF_MAX apart, whatever their signs.
+		using unsigned_type = std::make_unsigned_t<T>;
+
+		struct iota_iterator {
+			using iterator_category = std::random_access_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using value_type = T;
+			using pointer = void;
+			using reference = T;
+
+			T value{};
+
+			iota_iterator() = default;
+			explicit iota_iterator(T v) : value(v) {}
+
+			iota_iterator& operator++() {
+				++value;
+				return *this;
+			}
+
+			iota_iterator operator++(int) {
+				iota_iterator tmp(*this);
+				++(*this);
+				return tmp;
+			}
+
+			iota_iterator& operator--() {
+				--value;
+				return *this;
+			}
+
+			iota_iterator operator--(int) {
+				iota_iterator tmp(*this);
+				--(*this);
+				return tmp;
+			}
+
+			iota_iterator& operator+=(difference_type n) {
+				value = T(unsigned_type(value) + unsigned_type(n));
+				return *this;
+			}
+
+			iota_iterator& operator-=(difference_type n) {
+				value = T(unsigned_type(value) - unsigned_type(n));
+				return *this;
+			}
+
+			iota_iterator operator+(difference_type n) const {
+				iota_iterator tmp(*this);
+				return tmp += n;
+			}
+
+			friend iota_iterator operator+(difference_type n, const iota_iterator& it) {
+				return it + n;
+			}
+
+			iota_iterator operator-(difference_type n) const {
+				iota_iterator tmp(*this);
+				return tmp -= n;
+			}
+
+			difference_type operator-(const iota_iterator& other) const {
+				return difference_type(unsigned_type(value) - unsigned_type(other.value));
+			}
+
+			reference operator*() const {
+				return value;
+			}
+
+			reference operator[](difference_type n) const {
+				return *(*this + n);
+			}
+
+			bool operator==(const iota_iterator& other) const {
+				return value == other.value;
+			}
+
+			bool operator!=(const iota_iterator& other) const {
+				return !(*this == other);
+			}
+
+			bool operator<(const iota_iterator& other) const {
+				return value < other.value;
 			}
 
-			bool operator==(drop_iterator<Iter>& other) {
-				return (this->this_iter == other.this_iter);
+			bool operator>(const iota_iterator& other) const {
+				return other < *this;
 			}
 
-			bool operator!=(drop_iterator<Iter>& other) {
-				return !(this->this_iter == other.this_iter);
+			bool operator<=(const iota_iterator& other) const {
+				return !(other < *this);
+			}
+
+			bool operator>=(const iota_iterator& other) const {
+				return !(*this < other);
 			}
 		};
 
-		drop_iterator<iterator> begin() {
-			return Iter<iterator>(begin_);
+		using iterator = iota_iterator;
+
+		T first_;
+		T last_;
+
+		iota_range(T first, T last) : first_(first), last_(std::max(first, last)) {}
+
+		// As far from first as the type goes, but no further than PTRDIFF_MAX.
+		static T unbounded(T first) {
+			unsigned_type room = unsigned_type(std::numeric_limits<T>::max()) - unsigned_type(first);
+			auto reach = std::min<uintmax_t>(room, uintmax_t(std::numeric_limits<std::ptrdiff_t>::max()));
+			return T(unsigned_type(first) + unsigned_type(reach));
+		}
+
+		iterator begin() const {
+			return iterator(first_);
+		}
+
+		iterator end() const {
+			return iterator(last_);
+		}
+
+		size_t size() const {
+			return size_t(end() - begin());
+		}
+
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			return detail::push_iterators(begin(), end(), sink);
+		}
+
+		size_t slice_size() const {
+			return size();
+		}
+
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return detail::push_iterators(begin() + std::ptrdiff_t(from), begin() + std::ptrdiff_t(to), sink);
+		}
+
+		// Fills a buffer on the stack a block at a time.
+		template<typename Block>
+		void push_blocks(size_t from, size_t to, Block&& block) const {
+			T values[detail::block_size];
+			for (size_t i = from; i < to; i += detail::block_size) {
+				size_t n = std::min(detail::block_size, to - i);
+				T start = begin()[std::ptrdiff_t(i)];
+				for (size_t j = 0; j < n; ++j) {
+					values[j] = T(unsigned_type(start) + unsigned_type(j));
+				}
+				block(static_cast<const T*>(values), n);
+			}
 		}
+	};
+
+	// first, first + 1, ... for as long as the pipeline reads.
+	template<typename T>
+	iota_range<T> iota(T first) {
+		return iota_range<T>(first, iota_range<T>::unbounded(first));
+	}
+
+	template<typename T>
+	iota_range<T> iota(T first, T last) {
+		return iota_range<T>(first, last);
+	}
+} // namespace iota
+
+
+
+
+
+
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+namespace generator {
+	// The return type of a coroutine that yields the elements with co_yield:
+	//
+	//     generator::generator<int> squares() {
+	//         for (int i = 0;; ++i) {
+	//             co_yield i * i;
+	//         }
+	//     }
+	//
+	// The coroutine runs only as far as the pipeline reads, one element at a time, so
+	// it may be endless. It is a single pass input range: begin() returns the element
+	// the coroutine last yielded, so a second pass goes on where the first one left
+	// it. Copies share the coroutine, which is destroyed with the last of them; an
+	// exception it throws comes out of the read that resumed it.
+	template<typename T>
+	struct generator : detail::view_base {
+		struct promise_type;
+
+		using handle = std::coroutine_handle<promise_type>;
+
+		struct promise_type {
+			const T* current = nullptr;
+			std::exception_ptr error;
+
+			generator get_return_object() {
+				return generator(handle::from_promise(*this));
+			}
+
+			std::suspend_always initial_suspend() noexcept {
+				return {};
+			}
+
+			std::suspend_always final_suspend() noexcept {
+				return {};
+			}
+
+			// The yielded value lives in the coroutine until it is resumed.
+			std::suspend_always yield_value(const T& value) noexcept {
+				current = std::addressof(value);
+				return {};
+			}
+
+			void return_void() noexcept {}
+
+			void unhandled_exception() {
+				error = std::current_exception();
+			}
+		};
+
+		struct frame {
+			handle coroutine;
+			bool started = false;
+
+			explicit frame(handle h) : coroutine(h) {}
+
+			frame(const frame&) = delete;
+			frame& operator=(const frame&) = delete;
+
+			~frame() {
+				coroutine.destroy();
+			}
+
+			void resume() {
+				coroutine.resume();
+				if (coroutine.promise().error) {
+					std::rethrow_exception(std::exchange(coroutine.promise().error, nullptr));
+				}
+			}
+		};
+
+		// Null at the end.
+		struct generator_iterator {
+			using iterator_category = std::input_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using value_type = T;
+			using pointer = const T*;
+			using reference = const T&;
+
+			frame* frame_ = nullptr;
+
+			generator_iterator() = default;
+			explicit generator_iterator(frame* f) : frame_(f) {}
+
+			generator_iterator& operator++() {
+				frame_->resume();
+				return *this;
+			}
+
+			void operator++(int) {
+				++(*this);
+			}
+
+			reference operator*() const {
+				return *frame_->coroutine.promise().current;
+			}
+
+			pointer operator->() const {
+				return frame_->coroutine.promise().current;
+			}
+
+			bool done() const {
+				return frame_ == nullptr || frame_->coroutine.done();
+			}
+
+			bool operator==(const generator_iterator& other) const {
+				return done() == other.done();
+			}
+
+			bool operator!=(const generator_iterator& other) const {
+				return !(*this == other);
+			}
+		};
+
+		using iterator = generator_iterator;
+
+		std::shared_ptr<frame> frame_;
+
+		explicit generator(handle h) : frame_(std::make_shared<frame>(h)) {}
+
+		iterator begin() const {
+			if (!frame_->started) {
+				frame_->started = true;
+				frame_->resume();
+			}
+			return iterator(frame_.get());
+		}
+
+		iterator end() const {
+			return iterator();
+		}
+
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			return detail::push_iterators(begin(), end(), sink);
+		}
+	};
+} // namespace generator
+#endif
+
+
+
+
+
+namespace drop {
+	struct drop_helper {
+		size_t helper;
+		drop_helper(size_t d) : helper(d) {}
+	};
+
+	// Iterates with the iterators of the underlying range, from the amount-th element on;
+	// begin() is constant time over random access ranges.
+	template<typename Base>
+	struct dropped_range : detail::view_base {
+		using iterator = detail::iterator_t<const Base>;
+
+		Base base_;
+		size_t amount_;
+
+		dropped_range(Base base, size_t amount) : base_(std::move(base)), amount_(amount) {}
+
+		iterator begin() const {
+			return detail::advance_bounded(base_.begin(), amount_, base_.end());
+		}
+
+		iterator end() const {
+			return base_.end();
+		}
+
+		template<typename B = Base, typename = std::enable_if_t<detail::is_sized_v<B>>>
+		size_t size() const {
+			size_t size = base_.size();
+			return size > amount_ ? size - amount_ : 0;
+		}
+
+		// Skips by index when the base allows it, so the loop itself does not count.
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			if constexpr (detail::is_at_least_v<iterator, std::random_access_iterator_tag>) {
+				return detail::push_iterators(begin(), end(), sink);
+			} else {
+				size_t skip = amount_;
+				return base_.push([&](auto&& x) {
+					if (skip != 0) {
+						--skip;
+						return true;
+					}
+					return detail::feed(sink, std::forward<decltype(x)>(x));
+				});
+			}
+		}
+
+		template<typename B = Base, typename = std::enable_if_t<detail::is_random_access_v<B>>>
+		size_t slice_size() const {
+			return size_t(end() - begin());
+		}
+
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return detail::push_iterators(begin() + std::ptrdiff_t(from), begin() + std::ptrdiff_t(to), sink);
+		}
+	};
+
+	template<typename Range>
+	dropped_range<detail::all_t<Range>> operator|(Range&& range, const drop_helper& h) {
+		return dropped_range<detail::all_t<Range>>(detail::all(std::forward<Range>(range)), h.helper);
+	}
+
+	inline drop_helper drop(drop_helper h) {
+		return h;
+	}
+} // namespace drop
+
+
+
+
+
+
+namespace take {
+	struct take_helper {
+		size_t helper;
+		take_helper(size_t r) : helper(r) {}
+	};
+
+	// Over a random access range, iterates with its iterators up to the amount-th one;
+	// over any other, with take_iterator.
+	template<typename Base>
+	struct take_range : detail::view_base {
+		using container_iterator = detail::iterator_t<const Base>;
+
+		static constexpr bool random_access = detail::is_at_least_v<container_iterator, std::random_access_iterator_tag>;
+
+		// An underlying iterator and how many elements may still be taken; it equals the
+		// end once that reaches zero, even if the underlying range goes on.
+		struct take_iterator {
+			using iterator_category = detail::category_t<container_iterator, std::forward_iterator_tag>;
+			using difference_type = std::ptrdiff_t;
+			using value_type = typename std::iterator_traits<container_iterator>::value_type;
+			using pointer = typename std::iterator_traits<container_iterator>::pointer;
+			using reference = typename std::iterator_traits<container_iterator>::reference;
+
+			container_iterator this_iter{};
+			size_t remaining = 0;
+
+			take_iterator() = default;
+			take_iterator(container_iterator it, size_t left) : this_iter(it), remaining(left) {}
+
+			take_iterator& operator++() {
+				++this_iter;
+				--remaining;
+				return *this;
+			}
+
+			take_iterator operator++(int) {
+				take_iterator tmp(*this);
+				++(*this);
+				return tmp;
+			}
+
+			reference operator*() const {
+				return *this_iter;
+			}
+
+			bool operator==(const take_iterator& other) const {
+				return remaining == other.remaining || this_iter == other.this_iter;
+			}
+
+			bool operator!=(const take_iterator& other) const {
+				return !(*this == other);
+			}
+		};
+
+		Base base_;
+		size_t amount_;
+
+		using iterator = std::conditional_t<random_access, container_iterator, take_iterator>;
+
+		take_range(Base base, size_t amount) : base_(std::move(base)), amount_(amount) {}
+
+		iterator begin() const {
+			if constexpr (random_access) {
+				return base_.begin();
+			} else {
+				return take_iterator(base_.begin(), amount_);
+			}
+		}
+
+		iterator end() const {
+			if constexpr (random_access) {
+				return detail::advance_bounded(base_.begin(), amount_, base_.end());
+			} else {
+				return take_iterator(base_.end(), 0);
+			}
+		}
+
+		template<typename B = Base, typename = std::enable_if_t<detail::is_sized_v<B>>>
+		size_t size() const {
+			return std::min<size_t>(base_.size(), amount_);
+		}
+
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			if constexpr (random_access) {
+				return detail::push_iterators(begin(), end(), sink);
+			} else {
+				size_t left = amount_;
+				bool stopped = false;
+				if (left != 0) {
+					base_.push([&](auto&& x) {
+						if (!detail::feed(sink, std::forward<decltype(x)>(x))) {
+							stopped = true;
+							return false;
+						}
+						return --left != 0;
+					});
+				}
+				return !stopped;
+			}
+		}
+
+		template<typename B = Base, typename = std::enable_if_t<detail::is_random_access_v<B>>>
+		size_t slice_size() const {
+			return size_t(end() - begin());
+		}
+
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return detail::push_iterators(begin() + std::ptrdiff_t(from), begin() + std::ptrdiff_t(to), sink);
+		}
+	};
+
+	template<typename Range>
+	take_range<detail::all_t<Range>> operator|(Range&& range, const take_helper& h) {
+		return take_range<detail::all_t<Range>>(detail::all(std::forward<Range>(range)), h.helper);
+	}
+
+	inline take_helper take(take_helper h) {
+		return h;
+	}
+} // namespace take
+
+
+
+
+
+namespace transform {
+	template<typename Function>
+	struct transform_helper {
+		Function helper;
+		transform_helper(Function f) : helper(std::move(f)) {}
+	};
+
+	template<typename Base, typename Replacement>
+	struct transform_range : detail::view_base {
+		using container_iterator = detail::iterator_t<const Base>;
+
+		// Applies the function on every dereference; the function lives in the range.
+		// Moves like the underlying iterator, up to random access.
+		struct transform_iterator {
+			using iterator_category = detail::category_t<container_iterator, std::random_access_iterator_tag>;
+			using difference_type = std::ptrdiff_t;
+			using reference = decltype(std::declval<const Replacement&>()(*std::declval<container_iterator>()));
+			using value_type = detail::remove_cvref_t<reference>;
+			using pointer = void;
+
+			container_iterator this_iter{};
+			const Replacement* condition = nullptr;
+
+			transform_iterator() = default;
+			transform_iterator(container_iterator it, const Replacement* what) : this_iter(it), condition(what) {}
+
+			transform_iterator& operator++() {
+				++this_iter;
+				return *this;
+			}
+
+			transform_iterator operator++(int) {
+				transform_iterator tmp(*this);
+				++(*this);
+				return tmp;
+			}
+
+			transform_iterator& operator--() {
+				--this_iter;
+				return *this;
+			}
+
+			transform_iterator operator--(int) {
+				transform_iterator tmp(*this);
+				--(*this);
+				return tmp;
+			}
+
+			transform_iterator& operator+=(difference_type n) {
+				this_iter += n;
+				return *this;
+			}
+
+			transform_iterator& operator-=(difference_type n) {
+				this_iter -= n;
+				return *this;
+			}
+
+			transform_iterator operator+(difference_type n) const {
+				return transform_iterator(this_iter + n, condition);
+			}
+
+			friend transform_iterator operator+(difference_type n, const transform_iterator& it) {
+				return it + n;
+			}
+
+			transform_iterator operator-(difference_type n) const {
+				return transform_iterator(this_iter - n, condition);
+			}
+
+			difference_type operator-(const transform_iterator& other) const {
+				return this_iter - other.this_iter;
+			}
+
+			reference operator*() const {
+				return (*condition)(*this_iter);
+			}
+
+			reference operator[](difference_type n) const {
+				return (*condition)(this_iter[n]);
+			}
+
+			bool operator==(const transform_iterator& other) const {
+				return this_iter == other.this_iter;
+			}
+
+			bool operator!=(const transform_iterator& other) const {
+				return !(*this == other);
+			}
+
+			bool operator<(const transform_iterator& other) const {
+				return this_iter < other.this_iter;
+			}
+
+			bool operator>(const transform_iterator& other) const {
+				return other < *this;
+			}
+
+			bool operator<=(const transform_iterator& other) const {
+				return !(other < *this);
+			}
+
+			bool operator>=(const transform_iterator& other) const {
+				return !(*this < other);
+			}
+		};
+
+		Base base_;
+		Replacement condition_;
+
+		transform_range(Base base, Replacement r) : base_(std::move(base)), condition_(std::move(r)) {}
+
+		transform_iterator begin() const {
+			return transform_iterator(base_.begin(), &condition_);
+		}
+
+		transform_iterator end() const {
+			return transform_iterator(base_.end(), &condition_);
+		}
+
+		template<typename B = Base, typename = std::enable_if_t<detail::is_sized_v<B>>>
+		size_t size() const {
+			return base_.size();
+		}
+
+		// The sink of the stage below: applies the function and passes the result on.
+		template<typename Sink>
+		auto stage(Sink& sink) const {
+			return [this, &sink](auto&& x) {
+				return detail::feed(sink, condition_(std::forward<decltype(x)>(x)));
+			};
+		}
+
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			return base_.push(stage(sink));
+		}
+
+		template<typename B = Base, typename = std::enable_if_t<detail::is_sliceable_v<B>>>
+		size_t slice_size() const {
+			return base_.slice_size();
+		}
+
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return base_.push_slice(from, to, stage(sink));
+		}
+
+		template<typename Block, typename B = Base, typename = std::enable_if_t<detail::is_blocked_v<B>
+			&& detail::is_block_invocable_v<Replacement, B> && std::is_arithmetic<typename transform_iterator::value_type>::value>>
+		void push_blocks(size_t from, size_t to, Block&& block) const {
+			using value_type = typename transform_iterator::value_type;
+			base_.push_blocks(from, to, [this, &block](const auto* data, size_t n) {
+				value_type mapped[detail::block_size];
+				for (size_t i = 0; i < n; ++i) {
+					mapped[i] = condition_(data[i]);
+				}
+				block(static_cast<const value_type*>(mapped), n);
+			});
+		}
+	};
+
+	template<typename Range, typename Replacement>
+	transform_range<detail::all_t<Range>, Replacement> operator|(Range&& range, const transform_helper<Replacement>& h) {
+		return transform_range<detail::all_t<Range>, Replacement>(detail::all(std::forward<Range>(range)), h.helper);
+	}
+
+	template<typename Replacement>
+	transform_helper<Replacement> transform(Replacement h) {
+		return transform_helper<Replacement>(std::move(h));
+	}
+} // namespace transform
+
+
+
+
+
+
+namespace filter {
+	template<typename Condition>
+	struct filter_helper {
+		Condition helper;
+		filter_helper(Condition c) : helper(std::move(c)) {}
+	};
+
+	template<typename Base, typename Condition>
+	struct filter_distance : detail::view_base {
+		using container_iterator = detail::iterator_t<const Base>;
+
+		// Always rests on an element that satisfies the condition, or on the end, so the
+		// condition is evaluated once per element and dereferencing never calls it.
+		// Bidirectional at most, since a step may skip any number of elements.
+		struct filter_iterator {
+			using iterator_category = detail::category_t<container_iterator, std::bidirectional_iterator_tag>;
+			using difference_type = std::ptrdiff_t;
+			using value_type = typename std::iterator_traits<container_iterator>::value_type;
+			using pointer = typename std::iterator_traits<container_iterator>::pointer;
+			using reference = typename std::iterator_traits<container_iterator>::reference;
+
+			container_iterator begin_{};
+			container_iterator end_{};
+			const Condition* condition = nullptr;
+
+			filter_iterator() = default;
+			filter_iterator(container_iterator a, container_iterator b, const Condition* c) : begin_(a), end_(b), condition(c) {
+				satisfy();
+			}
+
+			void satisfy() {
+				while (begin_ != end_ && !(*condition)(*begin_)) {
+					++begin_;
+				}
+			}
+
+			filter_iterator& operator++() {
+				++begin_;
+				satisfy();
+				return *this;
+			}
+
+			filter_iterator operator++(int) {
+				filter_iterator tmp(*this);
+				++(*this);
+				return tmp;
+			}
+
+			filter_iterator& operator--() {
+				do {
+					--begin_;
+				} while (!(*condition)(*begin_));
+				return *this;
+			}
+
+			filter_iterator operator--(int) {
+				filter_iterator tmp(*this);
+				--(*this);
+				return tmp;
+			}
+
+			reference operator*() const {
+				return *begin_;
+			}
+
+			bool operator==(const filter_iterator& other) const {
+				return begin_ == other.begin_;
+			}
+
+			bool operator!=(const filter_iterator& other) const {
+				return !(*this == other);
+			}
+		};
+
+		Base base_;
+		Condition condition_;
+
+		filter_distance(Base base, Condition c) : base_(std::move(base)), condition_(std::move(c)) {}
+
+		filter_iterator begin() const {
+			return filter_iterator(base_.begin(), base_.end(), &condition_);
+		}
+
+		filter_iterator end() const {
+			return filter_iterator(base_.end(), base_.end(), &condition_);
+		}
+
+		// The sink of the stage below: passes on the elements that satisfy the condition.
+		template<typename Sink>
+		auto stage(Sink& sink) const {
+			return [this, &sink](auto&& x) {
+				return !condition_(x) || detail::feed(sink, std::forward<decltype(x)>(x));
+			};
+		}
+
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			return base_.push(stage(sink));
+		}
+
+		template<typename B = Base, typename = std::enable_if_t<detail::is_sliceable_v<B>>>
+		size_t slice_size() const {
+			return base_.slice_size();
+		}
+
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return base_.push_slice(from, to, stage(sink));
+		}
+
+		// Tests the whole block first. A block that passes entirely is handed on as it
+		// is; otherwise the elements that passed are compacted into a buffer.
+		template<typename Block, typename B = Base, typename = std::enable_if_t<detail::is_blocked_v<B>
+			&& detail::is_block_invocable_v<Condition, B>>>
+		void push_blocks(size_t from, size_t to, Block&& block) const {
+			base_.push_blocks(from, to, [this, &block](const auto* data, size_t n) {
+				using value_type = std::remove_cv_t<std::remove_pointer_t<decltype(data)>>;
+				unsigned char keep[detail::block_size];
+				size_t passed = 0;
+				for (size_t i = 0; i < n; ++i) {
+					keep[i] = condition_(data[i]) ? 1 : 0;
+					passed += keep[i];
+				}
+				if (passed == n) {
+					block(data, n);
+					return;
+				}
+				if (passed == 0) {
+					return;
+				}
+				value_type kept[detail::block_size];
+				size_t count = detail::compact(data, keep, n, kept);
+				block(static_cast<const value_type*>(kept), count);
+			});
+		}
+	};
+
+	template<typename Range, typename Condition>
+	filter_distance<detail::all_t<Range>, Condition> operator|(Range&& range, const filter_helper<Condition>& h) {
+		return filter_distance<detail::all_t<Range>, Condition>(detail::all(std::forward<Range>(range)), h.helper);
+	}
+
+	template<typename Condition>
+	filter_helper<Condition> filter(Condition h) {
+		return filter_helper<Condition>(std::move(h));
+	}
+} // namespace filter
+
+
+
+
+
+
+namespace detail {
+	template<typename Value, typename = void>
+	struct is_hashable : std::false_type {};
+
+	template<typename Value>
+	struct is_hashable<Value, std::enable_if_t<std::is_default_constructible<std::hash<Value>>::value>> : std::true_type {};
+
+	template<typename Value, typename = void>
+	struct is_ordered : std::false_type {};
+
+	template<typename Value>
+	struct is_ordered<Value, std::void_t<decltype(std::declval<const Value&>() < std::declval<const Value&>())>> : std::true_type {};
+
+	template<typename Value, typename = void>
+	struct is_range : std::false_type {};
+
+	template<typename Value>
+	struct is_range<Value, std::void_t<decltype(std::begin(std::declval<const Value&>()))>> : std::true_type {};
+
+	// Keys given as string literals are stored, and compared, as strings.
+	template<typename Value>
+	using stored_key_t = std::conditional_t<std::is_same<std::decay_t<Value>, const char*>::value
+		|| std::is_same<std::decay_t<Value>, char*>::value, std::string, std::remove_cv_t<Value>>;
+
+	// Up to this many keys are compared one by one, which beats hashing them.
+	constexpr size_t linear_keys = 8;
+
+	// The keys given to keys() or values(), looked up once per element of the range.
+	// A few keys are scanned; more are hashed, or sorted and binary searched if the
+	// type has no std::hash.
+	template<typename Value, bool = is_hashable<Value>::value>
+	struct key_set {
+		std::vector<Value> list_;
+		std::unordered_set<Value> hashed_;
+
+		template<typename Iterator>
+		key_set(Iterator first, Iterator last) : list_(first, last) {
+			if (list_.size() > linear_keys) {
+				hashed_.insert(list_.begin(), list_.end());
+				list_.clear();
+			}
+		}
+
+		bool contains(const Value& value) const {
+			if (hashed_.empty()) {
+				return std::find(list_.begin(), list_.end(), value) != list_.end();
+			}
+			return hashed_.count(value) != 0;
+		}
+	};
+
+	template<typename Value>
+	struct key_set<Value, false> {
+		std::vector<Value> list_;
+		bool sorted_ = false;
+
+		template<typename Iterator>
+		key_set(Iterator first, Iterator last) : list_(first, last) {
+			if constexpr (is_ordered<Value>::value) {
+				if (list_.size() > linear_keys) {
+					std::sort(list_.begin(), list_.end());
+					sorted_ = true;
+				}
+			}
+		}
+
+		bool contains(const Value& value) const {
+			if constexpr (is_ordered<Value>::value) {
+				if (sorted_) {
+					return std::binary_search(list_.begin(), list_.end(), value);
+				}
+			}
+			return std::find(list_.begin(), list_.end(), value) != list_.end();
+		}
+	};
+} // namespace detail
+
+// keys and values drop the entries of an associative range whose key (value) is
+// among the given ones, or for which the given predicate holds. The keys may come as
+// a braced list or any range; they are put into a key_set when the helper is made,
+// and the pipeline's stages share it.
+namespace keys {
+	template<typename Value>
+	struct keys_helper {
+		std::shared_ptr<const detail::key_set<Value>> helper;
+
+		template<typename Iterator>
+		keys_helper(Iterator first, Iterator last) : helper(std::make_shared<const detail::key_set<Value>>(first, last)) {}
+	};
+
+	template<typename Predicate>
+	struct keys_if_helper {
+		Predicate helper;
+	};
+
+	template<typename Value>
+	struct check_keys {
+		std::shared_ptr<const detail::key_set<Value>> data;
+
+		template<typename Entry>
+		bool operator()(const Entry& entry) const {
+			return !data->contains(entry.first);
+		}
+	};
+
+	template<typename Base, typename Value>
+	using keys_distance = filter::filter_distance<Base, check_keys<Value>>;
+
+	template<typename Range, typename Value>
+	keys_distance<detail::all_t<Range>, Value> operator|(Range&& range, const keys_helper<Value>& h) {
+		static_assert(detail::is_pair_like<detail::range_value_t<Range>>::value, "keys() needs a range of key-value pairs");
+		return keys_distance<detail::all_t<Range>, Value>(detail::all(std::forward<Range>(range)), check_keys<Value>{h.helper});
+	}
+
+	template<typename Range, typename Predicate>
+	auto operator|(Range&& range, const keys_if_helper<Predicate>& h) {
+		static_assert(detail::is_pair_like<detail::range_value_t<Range>>::value, "keys() needs a range of key-value pairs");
+		return std::forward<Range>(range) | filter::filter(std::not_fn(h.helper));
+	}
+
+	template<typename Value>
+	keys_helper<detail::stored_key_t<Value>> keys(std::initializer_list<Value> v) {
+		return keys_helper<detail::stored_key_t<Value>>(v.begin(), v.end());
+	}
+
+	// The keys to drop as a range, or a predicate on entries.
+	template<typename Argument>
+	auto keys(const Argument& argument) {
+		if constexpr (detail::is_range<Argument>::value) {
+			return keys_helper<detail::stored_key_t<detail::range_value_t<const Argument>>>(std::begin(argument), std::end(argument));
+		} else {
+			return keys_if_helper<std::decay_t<Argument>>{argument};
+		}
+	}
+} // namespace keys
+
+
+
+
+
+
+
+
+namespace values {
+	template<typename Value>
+	struct values_helper {
+		std::shared_ptr<const detail::key_set<Value>> helper;
 
-		drop_iterator<iterator> end() {
-			return Iter<iterator>(c.end());
-		}
+		template<typename Iterator>
+		values_helper(Iterator first, Iterator last) : helper(std::make_shared<const detail::key_set<Value>>(first, last)) {}
 	};
 
-	template<typename Container1, typename Container2>
-	struct is_compatible {
-		static constexpr bool value = std::is_same_v<Container1, Container2>;
+	template<typename Predicate>
+	struct values_if_helper {
+		Predicate helper;
 	};
 
-	template <typename Container1, typename Container2>
-	constexpr bool is_compatible_v = is_compatible<Container1, Container2>::value;
+	template<typename Value>
+	struct check_values {
+		std::shared_ptr<const detail::key_set<Value>> data;
 
-	template <typename Container1, typename Container2>
-	using enable_if_compatible = std::enable_if_t<is_compatible_v<Container1, Container2>, int>;
+		template<typename Entry>
+		bool operator()(const Entry& entry) const {
+			return !data->contains(entry.second);
+		}
+	};
 
-	template <typename Container>
-	dropped_range<Container> operator|(Container& c, const drop_helper& f) {
-		return dropped_range<Container>(c, f.helper);
-	}
+	template<typename Base, typename Value>
+	using values_distance = filter::filter_distance<Base, check_values<Value>>;
 
-	template <typename Container>
-	dropped_range<Container>operator|(const Container& c, const drop_helper& f) {
-		return dropped_range<Container>(c, f.helper);
+	template<typename Range, typename Value>
+	values_distance<detail::all_t<Range>, Value> operator|(Range&& range, const values_helper<Value>& h) {
+		static_assert(detail::is_pair_like<detail::range_value_t<Range>>::value, "values() needs a range of key-value pairs");
+		return values_distance<detail::all_t<Range>, Value>(detail::all(std::forward<Range>(range)), check_values<Value>{h.helper});
 	}
 
-	template <typename Container1, typename Container2, typename = enable_if_compatible<Container1, Container2>>
-	dropped_range<Container1> operator|(dropped_range<Container1>& c, const drop_helper& f) {
-		static_assert(is_compatible_v<Container1, Container2>, "Containers are not compatible");
-		return dropped_range<Container1>(c, f.helper);
+	template<typename Range, typename Predicate>
+	auto operator|(Range&& range, const values_if_helper<Predicate>& h) {
+		static_assert(detail::is_pair_like<detail::range_value_t<Range>>::value, "values() needs a range of key-value pairs");
+		return std::forward<Range>(range) | filter::filter(std::not_fn(h.helper));
 	}
-	
-}; // namespace drop
-
-drop::drop_helper drop(size_t x) {
-	return drop::drop_helper(x);
-}
-
 
+	template<typename Value>
+	values_helper<detail::stored_key_t<Value>> values(std::initializer_list<Value> v) {
+		return values_helper<detail::stored_key_t<Value>>(v.begin(), v.end());
+	}
 
+	// The values to drop as a range, or a predicate on entries.
+	template<typename Argument>
+	auto values(const Argument& argument) {
+		if constexpr (detail::is_range<Argument>::value) {
+			return values_helper<detail::stored_key_t<detail::range_value_t<const Argument>>>(std::begin(argument), std::end(argument));
+		} else {
+			return values_if_helper<std::decay_t<Argument>>{argument};
+		}
+	}
+} // namespace values
 
 
 
-namespace take {
-	struct take_helper {
-		size_t helper;
-		take_helper(size_t r) : helper(r) {}
-	};
 
-	template <typename Container>
-	struct take_range {
-		using iterator = typename Container::iterator;
 
-		iterator end_;
-		Container container;
 
-		take_range(Container& c, size_t amount) : container(c) {
-			end_ = c.begin();
-			for (size_t i = 0; i < amount; ++i) {
-				end_++;
-			}
-		}
 
-		template<typename Iterator>
-		struct take_iterator {
-			using iterator_category = std::forward_iterator_tag;
-			using value_type = typename Container::value_type;
-			using pointer = Iterator*;
-			using reference = Iterator&;
+namespace reverse {
+	struct reverse_helper {};
 
-			Iterator this_iter;
-			take_iterator(const Iterator* other_iter) : this_iter(other_iter) {}
+	template<typename Base>
+	struct reverse_distance : detail::view_base {
+		using iterator = std::reverse_iterator<detail::iterator_t<const Base>>;
 
-			take_iterator& operator++() {
-				this_iter++;
-				return *this;
-			}
+		Base base_;
 
-			take_iterator& operator++(int) {
-				take_iterator tmp(*this);
-				++(*this);
-				return tmp;
-			}
+		explicit reverse_distance(Base base) : base_(std::move(base)) {}
 
-			value_type operator*() {
-				return *this_iter;
-			}
+		iterator begin() const {
+			return iterator(base_.end());
+		}
 
-			pointer operator->() const {
-				return std::addressof(operator*());
-			}
+		iterator end() const {
+			return iterator(base_.begin());
+		}
 
-			bool operator==(const take_iterator<Iterator>& other) const {
-				return (this->this_iter == other.this_iter);
-			}
+		template<typename B = Base, typename = std::enable_if_t<detail::is_sized_v<B>>>
+		size_t size() const {
+			return base_.size();
+		}
 
-			bool operator!=(const take_iterator<Iterator>& other) const {
-				return !(this->this_iter == other.this_iter);
-			}
-		};
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			return detail::push_iterators(begin(), end(), sink);
+		}
 
-		take_iterator<iterator> begin() {
-			return take_iterator<iterator>(container.begin());
+		template<typename B = Base, typename = std::enable_if_t<detail::is_random_access_v<B>>>
+		size_t slice_size() const {
+			return size_t(end() - begin());
 		}
 
-		take_iterator<iterator> end() {
-			return take_iterator<iterator>(this->end_);
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return detail::push_iterators(begin() + std::ptrdiff_t(from), begin() + std::ptrdiff_t(to), sink);
 		}
 	};
 
-	template <typename Container>
-	take_range<Container> operator|(Container& c, const take_helper& h) {
-		return take_range<Container>(c, h.helper);
+	template<typename Range>
+	reverse_distance<detail::all_t<Range>> operator|(Range&& range, const reverse_helper&) {
+		static_assert(detail::is_at_least_v<detail::iterator_t<const detail::all_t<Range>>, std::bidirectional_iterator_tag>,
+			"reverse() needs a bidirectional range");
+		return reverse_distance<detail::all_t<Range>>(detail::all(std::forward<Range>(range)));
 	}
 
-	template <typename Container1, typename Container2>
-	take_range<Container1> operator|(take_range<Container1>& c, const take_helper& h) {
-		static_assert(std::is_same_v<Container1, Container2>, "Containers are not compatible");
-		return take_range<Container1>(c, h.helper);
+	inline reverse_helper reverse() {
+		return reverse_helper();
 	}
-}; // namespace take
+} // namespace reverse
 
-take::take_helper take(size_t h) {
-	return take::take_helper(h);
-}
 
 
 
 
 
-namespace transform {
-	template <typename Value>
-	struct transform_helper {
-		Value helper;
-		transform_helper(Value v) : helper(v) {}
-	};
 
-	template<typename Container, typename Replacement>
-	struct transform_range {
+namespace detail {
+	// The elements [first, last) of another range, kept as two iterators: what chunk
+	// and slide yield, so that a piece costs the same whatever its length. A consumer
+	// that takes elements in bulk, such as insert(first, last) or a write of n at a
+	// time, can use begin() and end() directly.
+	template<typename Iterator>
+	struct subrange : view_base {
+		Iterator first_{};
+		Iterator last_{};
 
-		transform_range(Container& c, const Replacement& r) : container(c), condition(r) {}
+		subrange() = default;
+		subrange(Iterator first, Iterator last) : first_(first), last_(last) {}
 
-		using container_iterator = typename Container::iterator;
+		Iterator begin() const {
+			return first_;
+		}
 
-		template<typename Iterator>
-		struct transform_iterator {
-			using iterator_category = std::forward_iterator_tag;
-			using difference_type = std::ptrdiff_t;
-			using value_type = typename Container::value_type;
-			using pointer = Iterator*;
-			using reference = Iterator&;
+		Iterator end() const {
+			return last_;
+		}
 
-			Replacement condition;
-			Iterator this_iter;
+		bool empty() const {
+			return first_ == last_;
+		}
 
-			transform_iterator(const Replacement& what, const Iterator& other_iter) : condition(what), this_iter(other_iter) {}
+		template<typename I = Iterator, typename = std::enable_if_t<is_at_least_v<I, std::random_access_iterator_tag>>>
+		size_t size() const {
+			return size_t(last_ - first_);
+		}
 
-			bool operator==(const transform_iterator<Iterator>& other) const {
-				return (this->this_iter == other.this_iter);
-			}
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			return push_iterators(first_, last_, sink);
+		}
 
-			bool operator!=(const transform_iterator<Iterator>& other) const {
-				return !(this->this_iter == other.this_iter);
-			}
+		template<typename I = Iterator, typename = std::enable_if_t<is_at_least_v<I, std::random_access_iterator_tag>>>
+		size_t slice_size() const {
+			return size_t(last_ - first_);
+		}
 
-			transform_iterator& operator++() {
-				this_iter++;
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return push_iterators(first_ + std::ptrdiff_t(from), first_ + std::ptrdiff_t(to), sink);
+		}
+	};
+} // namespace detail
+
+
+
+
+
+
+
+namespace chunk {
+	struct chunk_helper {
+		size_t helper;
+		chunk_helper(size_t n) : helper(std::max<size_t>(n, 1)) {}
+	};
+
+	// Consecutive pieces of amount elements, the last one possibly shorter, as
+	// subranges of the underlying range.
+	template<typename Base>
+	struct chunk_range : detail::view_base {
+		using container_iterator = detail::iterator_t<const Base>;
+		using value_type = detail::subrange<container_iterator>;
+
+		// The piece [this_iter, next); next is found when the iterator moves, so that
+		// dereferencing costs nothing.
+		struct chunk_iterator {
+			using iterator_category = detail::category_t<container_iterator, std::forward_iterator_tag>;
+			using difference_type = std::ptrdiff_t;
+			using value_type = detail::subrange<container_iterator>;
+			using pointer = void;
+			using reference = value_type;
+
+			container_iterator this_iter{};
+			container_iterator next{};
+			container_iterator last{};
+			size_t amount = 1;
+
+			chunk_iterator() = default;
+			chunk_iterator(container_iterator it, container_iterator end, size_t n)
+				: this_iter(it), next(detail::advance_bounded(it, n, end)), last(end), amount(n) {}
+
+			chunk_iterator& operator++() {
+				this_iter = next;
+				next = detail::advance_bounded(next, amount, last);
 				return *this;
 			}
 
-			transform_iterator operator++(int) {
-				transform_iterator tmp(*this);
+			chunk_iterator operator++(int) {
+				chunk_iterator tmp(*this);
 				++(*this);
 				return tmp;
 			}
 
-			value_type operator*() {
-				return condition(*this_iter);
+			reference operator*() const {
+				return value_type(this_iter, next);
+			}
+
+			bool operator==(const chunk_iterator& other) const {
+				return this_iter == other.this_iter;
+			}
+
+			bool operator!=(const chunk_iterator& other) const {
+				return !(*this == other);
 			}
 		};
 
-		transform_iterator<container_iterator> begin() {
-			return transform_iterator<container_iterator>(condition, container.begin());
+		using iterator = chunk_iterator;
+
+		Base base_;
+		size_t amount_;
+
+		chunk_range(Base base, size_t amount) : base_(std::move(base)), amount_(amount) {}
+
+		iterator begin() const {
+			return iterator(base_.begin(), base_.end(), amount_);
 		}
 
-		transform_iterator<container_iterator> end() {
-			return transform_iterator<container_iterator>(condition, container.end());
+		iterator end() const {
+			return iterator(base_.end(), base_.end(), amount_);
 		}
 
-		Container container;
-		Replacement condition;
-	};
+		template<typename B = Base, typename = std::enable_if_t<detail::is_sized_v<B>>>
+		size_t size() const {
+			return (base_.size() + amount_ - 1) / amount_;
+		}
 
-	template <typename Container1, typename Replacement>
-	transform_range<Container1, Replacement> operator|(transform_range<Container1, Replacement>& c, const transform_helper<Replacement>& h) {
-		static_assert(std::is_same_v<Replacement, typename Container1::value_type>, "Container and Replacement types are incompatible");
-		return transform_range<Container1, Replacement>(c.container, h.helper);
-	}
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			return push_pieces(base_.begin(), base_.end(), sink);
+		}
 
-	template <typename Container, typename Replacement>
-	transform_range<Container, Replacement> operator|(Container& c, const transform_helper<Replacement>& h) {
-		return transform_range<Container, Replacement>(c, h.helper);
-	}
+		// Pieces [from, to), each a slice of amount source elements.
+		template<typename B = Base, typename = std::enable_if_t<detail::is_random_access_v<B>>>
+		size_t slice_size() const {
+			return (size_t(base_.end() - base_.begin()) + amount_ - 1) / amount_;
+		}
 
-	template <typename Container, typename Replacement>
-	transform_range<Container, Replacement> operator|(const Container& c, const transform_helper<Replacement>& h) {
-		return transform_range<Container, Replacement>(c, h.helper);
-	}
-}; // namespace transform
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			container_iterator first = detail::advance_bounded(base_.begin(), from * amount_, base_.end());
+			container_iterator last = detail::advance_bounded(base_.begin(), to * amount_, base_.end());
+			return push_pieces(first, last, sink);
+		}
 
-template <typename Replacement>
-transform::transform_helper<Replacement> transform(const Replacement& h) {
-	return transform::transform_helper<Replacement>(h);
-}
+		template<typename Sink>
+		bool push_pieces(container_iterator first, container_iterator last, Sink& sink) const {
+			while (first != last) {
+				container_iterator next = detail::advance_bounded(first, amount_, last);
+				if (!detail::feed(sink, value_type(first, next))) {
+					return false;
+				}
+				first = next;
+			}
+			return true;
+		}
+	};
 
+	template<typename Range>
+	chunk_range<detail::all_t<Range>> operator|(Range&& range, const chunk_helper& h) {
+		static_assert(detail::is_at_least_v<detail::iterator_t<const detail::all_t<Range>>, std::forward_iterator_tag>,
+			"chunk() needs a forward range");
+		return chunk_range<detail::all_t<Range>>(detail::all(std::forward<Range>(range)), h.helper);
+	}
 
+	inline chunk_helper chunk(chunk_helper h) {
+		return h;
+	}
+} // namespace chunk
 
 
 
 
-namespace keys {
-	template <typename Value>
-	struct keys_helper {
-		std::initializer_list<Value> helper;
-		keys_helper(const std::initializer_list<Value>& values) : helper(values) {}
-	};
 
-	template<typename Container, typename Value>
-	struct keys_distance {
-		using container_iterator = typename Container::iterator;
-		using key_type = typename Container::key_type;
-		using value_type = typename Container::value_type;
 
-		std::initializer_list<Value> data;
-		Container container;
 
-		keys_distance(Container& c, const std::initializer_list<Value>& values)
-			: container(c), data(values) {}
+namespace slide {
+	struct slide_helper {
+		size_t helper;
+		slide_helper(size_t n) : helper(std::max<size_t>(n, 1)) {}
+	};
 
-		template<typename Iterator>
-		struct keys_iterator {
-			using iterator_category = std::forward_iterator_tag;
+	// Every window of amount consecutive elements, first to last, as subranges of the
+	// underlying range; none if the range is shorter than that.
+	template<typename Base>
+	struct slide_range : detail::view_base {
+		using container_iterator = detail::iterator_t<const Base>;
+		using value_type = detail::subrange<container_iterator>;
+
+		// The window from this_iter to back, its last element, both moved together; it
+		// equals the end once back reaches the end of the range.
+		struct slide_iterator {
+			using iterator_category = detail::category_t<container_iterator, std::forward_iterator_tag>;
 			using difference_type = std::ptrdiff_t;
-			using pointer = Iterator*;
-			using reference = Iterator&;
-
-			Iterator begin_;
-			Iterator end_;
-			std::initializer_list<Value> data;
+			using value_type = detail::subrange<container_iterator>;
+			using pointer = void;
+			using reference = value_type;
 
-			explicit keys_iterator(const Iterator& a, const Iterator& b, const std::initializer_list<Value>& d)
-				: begin_(a), end_(b), data(d) {}
+			container_iterator this_iter{};
+			container_iterator back{};
 
-			bool check_keys(const value_type& key_value) {
-				for (const key_type& t : data) {
-					if (key_value.first == t) {
-						return false;
-					}
-				}
-				return true;
-			}
+			slide_iterator() = default;
+			slide_iterator(container_iterator first, container_iterator last) : this_iter(first), back(last) {}
 
-			keys_iterator& operator++() {
-				++begin_;
-				while (begin_ != end_ && check_keys(*begin_)) {
-					++begin_;
-				}
+			slide_iterator& operator++() {
+				++this_iter;
+				++back;
 				return *this;
 			}
 
-			keys_iterator operator++(int) {
-				keys_iterator tmp(*this);
+			slide_iterator operator++(int) {
+				slide_iterator tmp(*this);
 				++(*this);
 				return tmp;
 			}
 
-			value_type operator*() {
-				if (begin_ != end_ && check_keys(*begin_)) {
-					++(*this);
-				}
-				return *begin_;
+			reference operator*() const {
+				return value_type(this_iter, std::next(back));
 			}
 
-			bool operator==(const keys_iterator& other) const {
-				return (begin_ == other.begin_);
+			bool operator==(const slide_iterator& other) const {
+				return back == other.back;
 			}
 
-			bool operator!=(const keys_iterator& other) const {
+			bool operator!=(const slide_iterator& other) const {
 				return !(*this == other);
 			}
 		};
 
-		keys_iterator<container_iterator> begin() {
-			return keys_iterator<container_iterator>(container.begin(), container.end(), data);
+		using iterator = slide_iterator;
+
+		Base base_;
+		size_t amount_;
+
+		slide_range(Base base, size_t amount) : base_(std::move(base)), amount_(amount) {}
+
+		iterator begin() const {
+			return iterator(base_.begin(), detail::advance_bounded(base_.begin(), amount_ - 1, base_.end()));
 		}
 
-		keys_iterator<container_iterator> end() {
-			return keys_iterator<container_iterator>(container.end(), container.end(), data);
+		iterator end() const {
+			return iterator(base_.end(), base_.end());
 		}
-	};
 
-	template<typename Container, typename Value>
-	keys_distance<Container, Value> operator|(Container& c, const keys_helper<Value>& v) {
-		return keys_distance<Container, Value>(c, v.helper);
-	}
+		template<typename B = Base, typename = std::enable_if_t<detail::is_sized_v<B>>>
+		size_t size() const {
+			size_t size = base_.size();
+			return size >= amount_ ? size - amount_ + 1 : 0;
+		}
 
-	template<typename Container, typename Value>
-	keys_distance<Container, Value> operator|(const Container& c, const keys_helper<Value>& v) {
-		return keys_distance<Container, Value>(c, v.helper);
-	}
-}; // namespace keys
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			container_iterator first = base_.begin();
+			container_iterator last = base_.end();
+			container_iterator back = detail::advance_bounded(first, amount_ - 1, last);
+			for (; back != last; ++first) {
+				++back;
+				if (!detail::feed(sink, value_type(first, back))) {
+					return false;
+				}
+			}
+			return true;
+		}
 
-template<typename Value>
-keys::keys_helper<Value> keys(std::initializer_list<Value> v) {
-	return keys::keys_helper<Value>(v);
-}
+		// Windows [from, to), by their first element.
+		template<typename B = Base, typename = std::enable_if_t<detail::is_random_access_v<B>>>
+		size_t slice_size() const {
+			size_t size = size_t(base_.end() - base_.begin());
+			return size >= amount_ ? size - amount_ + 1 : 0;
+		}
 
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			container_iterator first = base_.begin();
+			for (size_t i = from; i < to; ++i) {
+				if (!detail::feed(sink, value_type(first + std::ptrdiff_t(i), first + std::ptrdiff_t(i + amount_)))) {
+					return false;
+				}
+			}
+			return true;
+		}
+	};
 
+	template<typename Range>
+	slide_range<detail::all_t<Range>> operator|(Range&& range, const slide_helper& h) {
+		static_assert(detail::is_at_least_v<detail::iterator_t<const detail::all_t<Range>>, std::forward_iterator_tag>,
+			"slide() needs a forward range");
+		return slide_range<detail::all_t<Range>>(detail::all(std::forward<Range>(range)), h.helper);
+	}
 
+	inline slide_helper slide(slide_helper h) {
+		return h;
+	}
+} // namespace slide
 
 
 
 
 
-namespace values {
-	template<typename Value>
-	struct values_helper {
-		std::initializer_list<Value> helper;
-		values_helper(const std::initializer_list<Value>& values)
-			: helper(values) {}
-	};
 
-	template<typename Container, typename Value>
-	struct values_distance {
-		using container_iterator = typename Container::iterator;
-		using value_type = typename Container::value_type;
-		using mapped_type = typename Container::mapped_type;
 
-		std::initializer_list<Value> data;
-		Container container;
+namespace stride {
+	struct stride_helper {
+		size_t helper;
+		stride_helper(size_t n) : helper(std::max<size_t>(n, 1)) {}
+	};
 
-		values_distance(Container& c, const std::initializer_list<Value>& values)
-			: container(c), data(values) {}
+	// The first element and then every amount-th one after it.
+	template<typename Base>
+	struct stride_range : detail::view_base {
+		using container_iterator = detail::iterator_t<const Base>;
 
-		template<typename Iterator>
-		struct values_iterator {
-			using iterator_category = std::forward_iterator_tag;
+		// An underlying iterator that moves amount elements at a time, stopping at the end.
+		struct stride_iterator {
+			using iterator_category = detail::category_t<container_iterator, std::forward_iterator_tag>;
 			using difference_type = std::ptrdiff_t;
-			using pointer = Iterator*;
-			using reference = Iterator&;
-
-			Iterator begin_;
-			Iterator end_;
-			std::initializer_list<Value> data;
+			using value_type = typename std::iterator_traits<container_iterator>::value_type;
+			using pointer = typename std::iterator_traits<container_iterator>::pointer;
+			using reference = typename std::iterator_traits<container_iterator>::reference;
 
-			explicit values_iterator(const Iterator& a, const Iterator& b, const std::initializer_list<Value>& d)
-				: begin_(a), end_(b), data(d) {}
+			container_iterator this_iter{};
+			container_iterator last{};
+			size_t amount = 1;
 
-			bool check_values(const value_type& value) {
-				for (const mapped_type& m : data) {
-					if (value.second == m) {
-						return true;
-					}
-				}
-				return false;
-			}
+			stride_iterator() = default;
+			stride_iterator(container_iterator it, container_iterator end, size_t n) : this_iter(it), last(end), amount(n) {}
 
-			values_iterator& operator++() {
-				++begin_;
-				while (begin_ != end_ && check_values(*begin_)) {
-					++begin_;
-				}
+			stride_iterator& operator++() {
+				this_iter = detail::advance_bounded(this_iter, amount, last);
 				return *this;
 			}
 
-			values_iterator operator++(int) {
-				values_iterator tmp(*this);
+			stride_iterator operator++(int) {
+				stride_iterator tmp(*this);
 				++(*this);
 				return tmp;
 			}
 
-			value_type operator*() {
-				if (begin_ != end_ && check_values(*begin_)) {
-					++(*this);
-				}
-				return *begin_;
+			reference operator*() const {
+				return *this_iter;
 			}
 
-			bool operator==(const values_iterator& other) const {
-				return (begin_ == other.begin_);
+			bool operator==(const stride_iterator& other) const {
+				return this_iter == other.this_iter;
 			}
 
-			bool operator!=(const values_iterator& other) const {
+			bool operator!=(const stride_iterator& other) const {
 				return !(*this == other);
 			}
 		};
 
-		values_iterator<container_iterator> begin() {
-			return values_iterator<container_iterator>(container.begin(), container.end(), data);
+		using iterator = stride_iterator;
+
+		static constexpr bool random_access = detail::is_at_least_v<container_iterator, std::random_access_iterator_tag>;
+
+		Base base_;
+		size_t amount_;
+
+		stride_range(Base base, size_t amount) : base_(std::move(base)), amount_(amount) {}
+
+		iterator begin() const {
+			return iterator(base_.begin(), base_.end(), amount_);
+		}
+
+		iterator end() const {
+			return iterator(base_.end(), base_.end(), amount_);
+		}
+
+		template<typename B = Base, typename = std::enable_if_t<detail::is_sized_v<B>>>
+		size_t size() const {
+			return (base_.size() + amount_ - 1) / amount_;
+		}
+
+		// Steps by index when the base allows it; otherwise counts off the skipped ones.
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			if constexpr (random_access) {
+				return push_indices(0, size_t(base_.end() - base_.begin()), sink);
+			} else {
+				size_t skip = 0;
+				return base_.push([&](auto&& x) {
+					if (skip != 0) {
+						--skip;
+						return true;
+					}
+					skip = amount_ - 1;
+					return detail::feed(sink, std::forward<decltype(x)>(x));
+				});
+			}
+		}
+
+		template<typename B = Base, typename = std::enable_if_t<detail::is_random_access_v<B>>>
+		size_t slice_size() const {
+			return (size_t(base_.end() - base_.begin()) + amount_ - 1) / amount_;
+		}
+
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			return push_indices(from * amount_, std::min(to * amount_, size_t(base_.end() - base_.begin())), sink);
 		}
 
-		values_iterator<container_iterator> end() {
-			return values_iterator<container_iterator>(container.end(), container.end(), data);
+		template<typename Sink>
+		bool push_indices(size_t from, size_t to, Sink& sink) const {
+			container_iterator first = base_.begin();
+			for (size_t i = from; i < to; i += amount_) {
+				if (!detail::feed(sink, first[std::ptrdiff_t(i)])) {
+					return false;
+				}
+			}
+			return true;
 		}
 	};
 
-	template<typename Container, typename Value>
-	values_distance<Container, Value> operator|(Container& c, const values_helper<Value>& values) {
-		static_assert(std::is_same_v<Value, typename Container::mapped_type>, "Container and Value types are incompatible");
-		return values_distance<Container, Value>(c, values.helper);
+	template<typename Range>
+	stride_range<detail::all_t<Range>> operator|(Range&& range, const stride_helper& h) {
+		return stride_range<detail::all_t<Range>>(detail::all(std::forward<Range>(range)), h.helper);
 	}
 
-	template<typename Container, typename Value>
-	values_distance<Container, Value> operator|(const Container& c, const values_helper<Value>& values) {
-		static_assert(std::is_same_v<Value, typename Container::mapped_type>, "Container and Value types are incompatible");
-		return values_distance<Container, Value>(c, values.helper);
+	inline stride_helper stride(stride_helper h) {
+		return h;
 	}
-}; // namespace values
+} // namespace stride
 
-template<typename Value>
-values::values_helper<Value> values(std::initializer_list<Value> v) {
-	return values::values_helper<Value>(v);
-}
 
 
 
 
 
 
+namespace cache {
+	struct cache_helper {};
 
-namespace reverse {
-	struct reverse_helper {};
+	// Keeps the elements of the range in a vector as they are first read, so that the
+	// stages before it run once per element however often it is iterated: the first
+	// pass fetches from them, as far as it goes, and every later one reads the vector
+	// and goes on fetching where the furthest pass stopped. Copies of the range share
+	// the vector, which grows only as elements are fetched, so an endless range can be
+	// cached too. Until the range has been read to the end, a reference to an element
+	// may be invalidated by fetching the next one, and fetching is not thread safe;
+	// parallel terminal operations read it to the end before they start their threads.
+	template<typename Base>
+	struct cache_range : detail::view_base {
+		using container_iterator = detail::iterator_t<const Base>;
+		using value_type = typename std::iterator_traits<container_iterator>::value_type;
 
-	template<typename Container>
-	struct reverse_distance {
-		using container_iterator = typename Container::iterator;
-		using value_type = typename Container::value_type;
+		// The stages before the cache, the elements read so far and where to go on.
+		struct store {
+			Base base;
+			std::vector<value_type> values;
+			std::optional<container_iterator> next;
+			bool stored = false;
+			bool complete = false;
 
-		container_iterator end_;
-		Container container;
+			explicit store(Base b) : base(std::move(b)) {}
 
-		reverse_distance(Container& c) : container(c) {}
+			// Fetches elements until the i-th one is in values; false if there is none.
+			// next moves on only once its element is stored, so an element whose stages
+			// throw is fetched again the next time.
+			bool fetch(size_t i) {
+				while (i >= values.size() && !complete) {
+					if (!next) {
+						next.emplace(base.begin());
+					} else if (stored) {
+						++*next;
+					}
+					stored = false;
+					if (*next == base.end()) {
+						complete = true;
+						next.reset();
+					} else {
+						values.push_back(**next);
+						stored = true;
+					}
+				}
+				return i < values.size();
+			}
+		};
 
-		template<typename Iterator>
-		struct reverse_iterator {
-			using difference_type = std::ptrdiff_t;
-			using value_type = typename Container::value_type;
+		// An index into the vector, which fetches the element it moves to.
+		struct cache_iterator {
 			using iterator_category = std::forward_iterator_tag;
-			using pointer = Iterator*;
-			using reference = Iterator&;
+			using difference_type = std::ptrdiff_t;
+			using value_type = typename cache_range::value_type;
+			using pointer = const value_type*;
+			using reference = const value_type&;
 
-			Iterator temp_;
-			reverse_iterator(const Iterator& other)
-				: temp_(other.temp_) {}
+			store* store_ = nullptr;
+			size_t index = 0;
 
-			reverse_iterator& operator++() {
-				--temp_;
+			cache_iterator() = default;
+			cache_iterator(store* s, size_t i) : store_(s), index(i) {}
+
+			cache_iterator& operator++() {
+				++index;
 				return *this;
 			}
 
-			reverse_iterator operator++(int) {
-				reverse_iterator tmp(*this);
-				--temp_;
+			cache_iterator operator++(int) {
+				cache_iterator tmp(*this);
+				++(*this);
 				return tmp;
 			}
 
-			value_type operator*() {
-				return *temp_;
+			reference operator*() const {
+				store_->fetch(index);
+				return store_->values[index];
+			}
+
+			pointer operator->() const {
+				return &**this;
+			}
+
+			// The end iterator is the one without a store.
+			bool at_end() const {
+				return store_ == nullptr || !store_->fetch(index);
 			}
 
-			bool operator==(const reverse_iterator<Iterator>& other) const {
-				return (temp_ == other.temp_);
+			bool operator==(const cache_iterator& other) const {
+				if (store_ == nullptr || other.store_ == nullptr) {
+					return at_end() == other.at_end();
+				}
+				return index == other.index;
 			}
 
-			bool operator!=(const reverse_iterator<Iterator>& other) const {
-				return !(temp_ == other.temp_);
+			bool operator!=(const cache_iterator& other) const {
+				return !(*this == other);
 			}
 		};
 
-		reverse_iterator<container_iterator> begin() {
-			return reverse_iterator<container_iterator>(--container.end());
+		using iterator = cache_iterator;
+
+		std::shared_ptr<store> store_;
+
+		explicit cache_range(Base base) : store_(std::make_shared<store>(std::move(base))) {}
+
+		iterator begin() const {
+			return iterator(store_.get(), 0);
 		}
 
-		reverse_iterator<container_iterator> end() {
-			return reverse_iterator<container_iterator>(--container.begin());
+		iterator end() const {
+			return iterator();
+		}
+
+		template<typename B = Base, typename = std::enable_if_t<detail::is_sized_v<B>>>
+		size_t size() const {
+			return store_->base.size();
+		}
+
+		// Reads the vector in a counted loop once it is complete.
+		template<typename Sink>
+		bool push(Sink&& sink) const {
+			if (store_->complete) {
+				return detail::push_iterators(store_->values.cbegin(), store_->values.cend(), sink);
+			}
+			for (size_t i = 0; store_->fetch(i); ++i) {
+				if (!detail::feed(sink, static_cast<const value_type&>(store_->values[i]))) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Slicing reads the range to the end first.
+		size_t slice_size() const {
+			store_->fetch(std::numeric_limits<size_t>::max());
+			return store_->values.size();
 		}
-	};
 
-	template<typename Container1, typename Container2>
-	using enable_if_compatible = std::enable_if_t<std::is_same_v<typename Container1::value_type, typename Container2::value_type>, int>;
+		template<typename Sink>
+		bool push_slice(size_t from, size_t to, Sink&& sink) const {
+			auto first = store_->values.cbegin();
+			return detail::push_iterators(first + std::ptrdiff_t(from), first + std::ptrdiff_t(to), sink);
+		}
+
+		template<typename Block, typename V = value_type, typename = std::enable_if_t<std::is_arithmetic<V>::value>>
+		void push_blocks(size_t from, size_t to, Block&& block) const {
+			detail::push_data_blocks(store_->values.data(), from, to, block);
+		}
+	};
 
-	template<typename Container1, typename Container2, typename = enable_if_compatible<Container1, Container2>>
-	reverse_distance<Container1> operator|(reverse_distance<Container1>& c, const reverse_helper& h) {
-		static_assert(std::is_same_v<typename Container1::value_type, typename Container2::value_type>, "Container types are incompatible");
-		return reverse_distance<Container1>(c.container);
+	template<typename Range>
+	cache_range<detail::all_t<Range>> operator|(Range&& range, const cache_helper&) {
+		return cache_range<detail::all_t<Range>>(detail::all(std::forward<Range>(range)));
 	}
 
-	template<typename Container1, typename Container2, typename = enable_if_compatible<Container1, Container2>>
-	reverse_distance<Container1> operator|(const reverse_distance<Container1>& c, const reverse_helper& h) {
-		static_assert(std::is_same_v<typename Container1::value_type, typename Container2::value_type>, "Container types are incompatible");
-		return reverse_distance<Container1>(c.container);
+	inline cache_helper cache() {
+		return cache_helper();
 	}
-}; // namespace reverse
+} // namespace cache
 
-reverse::reverse_helper reverse() {
-	return reverse::reverse_helper();
-}
 
 
 
 
 
 
-namespace filter {
-	template <typename Value>
-	struct filter_helper {
-		Value helper;
-		filter_helper(Value v) : helper(v) {}
+namespace execution {
+	struct sequenced_policy {};
+
+	// Runs a pipeline on `threads` threads (0: one per hardware thread), each taking
+	// chunks of about min_chunk source positions at a time. Only sliceable pipelines
+	// are split: transform and filter over random access ranges, and drop, take and
+	// reverse over random access pipelines; any other runs sequentially. The
+	// pipeline's functions and conditions are then called concurrently.
+	struct parallel_policy {
+		size_t threads = 0;
+		size_t min_chunk = 1 << 14;
 	};
 
-	template<typename Container, typename Condition>
-	struct filter_distance {
-		Container container;
-		Condition condition;
+	inline constexpr sequenced_policy seq{};
+	inline constexpr parallel_policy par{};
+} // namespace execution
+
+namespace detail {
+	// Splits [0, view.slice_size()) into chunks, runs chunk(partial, from, to) for each
+	// on the policy's threads, and returns the partials in chunk order. The first
+	// exception thrown stops the remaining chunks and is rethrown.
+	template<typename Partial, typename View, typename Chunk>
+	std::vector<Partial> run_parallel(const execution::parallel_policy& policy, const View& view, Chunk chunk) {
+		size_t size = view.slice_size();
+		size_t threads = policy.threads != 0 ? policy.threads : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		size_t chunks = std::max<size_t>(std::min(size / std::max<size_t>(policy.min_chunk, 1), threads * 4), 1);
+		threads = std::min(threads, chunks);
+
+		std::vector<Partial> partials(chunks);
+		std::atomic<size_t> next{0};
+		std::mutex mutex;
+		std::exception_ptr error;
+		auto work = [&] {
+			try {
+				for (size_t i = next.fetch_add(1); i < chunks; i = next.fetch_add(1)) {
+					chunk(partials[i], size * i / chunks, size * (i + 1) / chunks);
+				}
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!error) {
+					error = std::current_exception();
+				}
+				next.store(chunks);
+			}
+		};
 
-		filter_distance(Container& c, const Condition& x) : container(c), condition(x) {}
+		std::vector<std::thread> workers;
+		for (size_t i = 1; i < threads; ++i) {
+			workers.emplace_back(work);
+		}
+		work();
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		if (error) {
+			std::rethrow_exception(error);
+		}
+		return partials;
+	}
 
-		using container_iterator = typename Container::iterator;
+	template<typename Range>
+	using collected_t = std::vector<range_value_t<const all_t<Range>>>;
+} // namespace detail
+
+// Terminal operations run a pipeline in one fused loop, sequentially or, given
+// execution::par, split over threads.
+namespace for_each {
+	// Calls function on every element of the range in one fused loop.
+	template<typename Range, typename Function>
+	void for_each(Range&& range, Function function) {
+		detail::push(range, [&function](auto&& x) {
+			function(std::forward<decltype(x)>(x));
+		});
+	}
 
-		template<typename Iterator>
-		struct filter_iterator {
-			using value_type = typename Container::value_type;
-			using difference_type = std::ptrdiff_t;
-			using iterator_category = std::forward_iterator_tag;
-			using pointer = Iterator*;
-			using reference = Iterator&;
+	template<typename Range, typename Function>
+	void for_each(const execution::sequenced_policy&, Range&& range, Function function) {
+		for_each(std::forward<Range>(range), std::move(function));
+	}
 
-			Condition condition;
-			Iterator begin_;
-			Iterator end_;
+	// In no particular order across chunks.
+	template<typename Range, typename Function>
+	void for_each(const execution::parallel_policy& policy, Range&& range, Function function) {
+		auto view = detail::all(std::forward<Range>(range));
+		if constexpr (detail::is_sliceable_v<decltype(view)>) {
+			detail::run_parallel<char>(policy, view, [&view, &function](char&, size_t from, size_t to) {
+				view.push_slice(from, to, [&function](auto&& x) {
+					function(std::forward<decltype(x)>(x));
+				});
+			});
+		} else {
+			for_each(view, std::move(function));
+		}
+	}
+} // namespace for_each
+
+namespace reduce {
+	// init combined with every element in order: op(op(init, a), b)...
+	template<typename Range, typename T, typename Operation>
+	T reduce(Range&& range, T init, Operation op) {
+		detail::push(range, [&init, &op](auto&& x) {
+			init = op(std::move(init), std::forward<decltype(x)>(x));
+		});
+		return init;
+	}
 
-			filter_iterator(const Condition& c, const Iterator& a, const Iterator& b)
-				: condition(c), begin_(a), end_(b) {}
+	template<typename Range, typename T, typename Operation>
+	T reduce(const execution::sequenced_policy&, Range&& range, T init, Operation op) {
+		return reduce(std::forward<Range>(range), std::move(init), std::move(op));
+	}
 
-			filter_iterator& operator++() {
-				if (begin_ != end_) {
-					do {
-						++begin_;
-					} while (begin_ != end_ && !condition(*begin_));
+	// Every chunk is folded on its own, then the chunks are combined with init in
+	// order, so op must be associative.
+	template<typename Range, typename T, typename Operation>
+	T reduce(const execution::parallel_policy& policy, Range&& range, T init, Operation op) {
+		auto view = detail::all(std::forward<Range>(range));
+		if constexpr (detail::is_sliceable_v<decltype(view)>) {
+			auto partials = detail::run_parallel<std::optional<T>>(policy, view,
+				[&view, &op](std::optional<T>& partial, size_t from, size_t to) {
+					view.push_slice(from, to, [&partial, &op](auto&& x) {
+						if (partial) {
+							*partial = op(std::move(*partial), std::forward<decltype(x)>(x));
+						} else {
+							partial.emplace(std::forward<decltype(x)>(x));
+						}
+					});
+				});
+			for (std::optional<T>& partial : partials) {
+				if (partial) {
+					init = op(std::move(init), std::move(*partial));
 				}
-				return *this;
 			}
+			return init;
+		} else {
+			return reduce(view, std::move(init), std::move(op));
+		}
+	}
+} // namespace reduce
+
+namespace collect {
+	// The elements of the range, in order, in a vector.
+	// Pipelines of arithmetic elements over contiguous containers are copied a block
+	// at a time.
+	template<typename Range>
+	detail::collected_t<Range> collect(Range&& range) {
+		detail::collected_t<Range> result;
+		if constexpr (detail::is_sized_v<detail::remove_cvref_t<Range>>) {
+			result.reserve(range.size());
+		}
+		if constexpr (detail::is_blocked_v<detail::remove_cvref_t<Range>>) {
+			range.push_blocks(0, range.slice_size(), [&result](const auto* data, size_t n) {
+				result.insert(result.end(), data, data + n);
+			});
+		} else {
+			detail::push(range, [&result](auto&& x) {
+				result.emplace_back(std::forward<decltype(x)>(x));
+			});
+		}
+		return result;
+	}
 
-			filter_iterator operator++(int) {
-				filter_iterator tmp(*this);
-				++(*this);
-				return tmp;
-			}
+	template<typename Range>
+	detail::collected_t<Range> collect(const execution::sequenced_policy&, Range&& range) {
+		return collect(std::forward<Range>(range));
+	}
 
-			value_type operator*() {
-				if (!condition(*begin_)) {
-					++(*this);
+	// Chunks are collected separately and concatenated in order.
+	template<typename Range>
+	detail::collected_t<Range> collect(const execution::parallel_policy& policy, Range&& range) {
+		using result_t = detail::collected_t<Range>;
+		auto view = detail::all(std::forward<Range>(range));
+		if constexpr (detail::is_sliceable_v<decltype(view)>) {
+			auto partials = detail::run_parallel<result_t>(policy, view, [&view](result_t& partial, size_t from, size_t to) {
+				if constexpr (detail::is_blocked_v<decltype(view)>) {
+					view.push_blocks(from, to, [&partial](const auto* data, size_t n) {
+						partial.insert(partial.end(), data, data + n);
+					});
+				} else {
+					view.push_slice(from, to, [&partial](auto&& x) {
+						partial.emplace_back(std::forward<decltype(x)>(x));
+					});
 				}
-				return *begin_;
-			}
-
-			bool operator==(const filter_iterator& other) const {
-				return (begin_ == other.begin_);
+			});
+			size_t size = 0;
+			for (const result_t& partial : partials) {
+				size += partial.size();
 			}
-
-			bool operator!=(const filter_iterator& other) const {
-				return !(*this == other);
+			result_t result;
+			result.reserve(size);
+			for (result_t& partial : partials) {
+				std::move(partial.begin(), partial.end(), std::back_inserter(result));
 			}
-		};
-
-		filter_iterator<container_iterator> begin() {
-			return filter_iterator<container_iterator>(condition, container.begin(), container.end());
+			return result;
+		} else {
+			return collect(view);
 		}
-
-		filter_iterator<container_iterator> end() {
-			return filter_iterator<container_iterator>(condition, container.end(), container.end());
+	}
+} // namespace collect
+
+namespace count {
+	// The number of elements; constant time for sized ranges.
+	template<typename Range>
+	size_t count(Range&& range) {
+		if constexpr (detail::is_sized_v<detail::remove_cvref_t<Range>>) {
+			return range.size();
+		} else {
+			size_t result = 0;
+			detail::push(range, [&result](auto&&) {
+				++result;
+			});
+			return result;
 		}
-	};
-
-	template<typename Container1, typename Container2>
-	using enable_if_compatible = std::enable_if_t<std::is_same_v<typename Container1::value_type, typename Container2::value_type>, int>;
-
-	template<typename Container1, typename Container2, typename = enable_if_compatible<Container1, Container2>>
-	filter_distance<Container1, Container2> operator|(filter_distance<Container1, Container2>& c, const filter_helper<Container2>& h) {
-		static_assert(std::is_same_v<typename Container1::value_type, typename Container2::value_type>, "Container types are incompatible");
-		return filter_distance<Container1, Container2>(c.container, h.helper);
 	}
 
-	template<typename Container1, typename Container2, typename = enable_if_compatible<Container1, Container2>>
-	filter_distance<Container1, Container2> operator|(const filter_distance<Container1, Container2>& c, const filter_helper<Container2>& h) {
-		static_assert(std::is_same_v<typename Container1::value_type, typename Container2::value_type>, "Container types are incompatible");
-		return filter_distance<Container1, Container2>(c.container, h.helper);
+	template<typename Range>
+	size_t count(const execution::sequenced_policy&, Range&& range) {
+		return count(std::forward<Range>(range));
 	}
-}; // namespace filter
-
-template<typename Condition>
-filter::filter_helper<Condition> filter(const Condition& h) {
-	return filter::filter_helper<Condition>(h);
-}
 
+	template<typename Range>
+	size_t count(const execution::parallel_policy& policy, Range&& range) {
+		auto view = detail::all(std::forward<Range>(range));
+		if constexpr (detail::is_sliceable_v<decltype(view)> && !detail::is_sized_v<decltype(view)>) {
+			auto partials = detail::run_parallel<size_t>(policy, view, [&view](size_t& partial, size_t from, size_t to) {
+				view.push_slice(from, to, [&partial](auto&&) {
+					++partial;
+				});
+			});
+			size_t result = 0;
+			for (size_t partial : partials) {
+				result += partial;
+			}
+			return result;
+		} else {
+			return count(view);
+		}
+	}
+} // namespace count
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "adapters.cpp"
+
+// collect() over vectors of int, float and double: the block kernels it picks for
+// contiguous arithmetic inputs against the element-by-element push it used before.
+// Elements that pass the filter come either in long runs, where branches predict
+// well, or at random, where the branch-free compaction pays off.
+
+static volatile size_t sink;
+
+template<typename Run>
+static double measure(Run run, size_t elements) {
+	constexpr int kRepeats = 20;
+	double best = 1e300;
+	for (int r = 0; r < kRepeats; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		sink = run();
+		std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+		best = std::min(best, time.count());
+	}
+	return best / double(elements);
+}
+
+template<typename Pipeline>
+static void report(const char* type, const char* name, const Pipeline& pipeline, size_t elements) {
+	using value_type = typename detail::collected_t<const Pipeline&>::value_type;
+	double blocks = measure([&pipeline] { return collect::collect(pipeline).size(); }, elements);
+	double scalar = measure([&pipeline] {
+		std::vector<value_type> result;
+		if constexpr (detail::is_sized_v<Pipeline>) {
+			result.reserve(pipeline.size());
+		}
+		for_each::for_each(pipeline, [&result](value_type x) { result.push_back(x); });
+		return result.size();
+	}, elements);
+	std::cout << type << "," << name << "," << blocks << "," << scalar << "," << scalar / blocks << std::endl;
+}
+
+// Runs of a thousand elements that all pass or all fail the filter, or random ones.
+template<typename T>
+static void run(const char* type) {
+	constexpr size_t kSize = 1000000;
+	std::vector<T> runs(kSize);
+	std::vector<T> random(kSize);
+	std::mt19937 generator(1);
+	for (size_t i = 0; i < kSize; ++i) {
+		runs[i] = T(i / 1000 % 1000);
+		random[i] = T(generator() % 1000);
+	}
+	auto map = [](T x) { return x * T(3) + T(1); };
+	auto keep = [](T x) { return x < T(500); };
+
+	report(type, "transform", random | transform::transform(map), kSize);
+	report(type, "filter (runs)", runs | filter::filter(keep), kSize);
+	report(type, "filter (random)", random | filter::filter(keep), kSize);
+	report(type, "filter|transform (random)", random | filter::filter(keep) | transform::transform(map), kSize);
+}
+
+int main() {
+	std::cout << "type,pipeline,blocks_ns,scalar_ns,speedup (per element)" << std::endl;
+	run<int>("int");
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
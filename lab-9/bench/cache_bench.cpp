@@ -0,0 +1,59 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "adapters.cpp"
+
+// An expensive transform read several times, as it is and behind cache(): without the
+// cache every pass calls the function on every element again, with it only the first
+// one does and the rest sum the cached vector. The cached runs include the first pass.
+
+static volatile double sink;
+
+template<typename Run>
+static double measure(Run run) {
+	constexpr int kRepeats = 5;
+	double best = 1e300;
+	for (int r = 0; r < kRepeats; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		sink = run();
+		std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+		best = std::min(best, time.count());
+	}
+	return best;
+}
+
+// Some hundred nanoseconds per element.
+static double expensive(int x) {
+	double value = x;
+	for (int i = 0; i < 32; ++i) {
+		value = std::sqrt(value * value + i);
+	}
+	return value;
+}
+
+template<typename Range>
+static double read(const Range& range, int passes) {
+	double total = 0;
+	for (int pass = 0; pass < passes; ++pass) {
+		total += reduce::reduce(range, 0.0, std::plus<double>());
+	}
+	return total;
+}
+
+int main() {
+	constexpr size_t kSize = 200000;
+	std::vector<int> data(kSize);
+	std::iota(data.begin(), data.end(), 0);
+	auto pipeline = data | transform::transform(expensive);
+
+	std::cout << "passes,uncached_ms,cached_ms,speedup" << std::endl;
+	for (int passes : { 1, 2, 4, 8, 16 }) {
+		double uncached = measure([&] { return read(pipeline, passes); });
+		double cached = measure([&] { return read(pipeline | cache::cache(), passes); });
+		std::cout << passes << "," << uncached << "," << cached << "," << uncached / cached << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,53 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <vector>
+
+#include "adapters.cpp"
+
+// drop, take, size(), std::distance and std::next on the same pipeline over a vector and over a
+// list. Over the vector the adapters keep random access and every operation is
+// constant time; over the list they walk the elements.
+
+static volatile int64_t sink;
+
+template<typename Run>
+static double measure(Run run) {
+	constexpr int kRepeats = 20;
+	double best = 1e300;
+	for (int r = 0; r < kRepeats; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		sink = run();
+		std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+		best = std::min(best, time.count());
+	}
+	return best;
+}
+
+template<typename Container>
+static void report(const char* name, const Container& numbers) {
+	size_t size = numbers.size();
+	auto pipeline = numbers | transform::transform([](int x) { return int64_t(x) * 3; }) | drop::drop(size / 2) | take::take(size / 4);
+
+	double begin = measure([&pipeline] { return *pipeline.begin(); });
+	double distance = measure([&pipeline] { return int64_t(std::distance(pipeline.begin(), pipeline.end())); });
+	double sized = measure([&pipeline] { return int64_t(pipeline.size()); });
+	double middle = measure([&pipeline, size] { return *std::next(pipeline.begin(), size / 8); });
+	std::cout << name << "," << size << "," << begin << "," << distance << "," << sized << "," << middle << std::endl;
+}
+
+int main() {
+	std::cout << "container,elements,first_element_ns,distance_ns,size_ns,middle_element_ns" << std::endl;
+	for (size_t size = 1000; size <= 1000000; size *= 10) {
+		std::vector<int> vector(size);
+		for (size_t i = 0; i < size; ++i) {
+			vector[i] = int(i);
+		}
+		std::list<int> list(vector.begin(), vector.end());
+		report("vector", vector);
+		report("list", list);
+	}
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "adapters.cpp"
+
+// Consumers that take elements in bulk, fed the pieces of chunk() against the same
+// consumers fed one element at a time: fwrite of a whole piece against one call per
+// element, and vector::insert of a piece against push_back, straight from a vector
+// and through a transform. Pieces are subranges of the source, so chunking copies
+// nothing.
+
+static volatile size_t sink;
+
+template<typename Run>
+static double measure(Run run, size_t elements) {
+	constexpr int kRepeats = 10;
+	double best = 1e300;
+	for (int r = 0; r < kRepeats; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		sink = run();
+		std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+		best = std::min(best, time.count());
+	}
+	return best / double(elements);
+}
+
+static void report(const char* consumer, size_t piece, double bulk, double single) {
+	std::cout << consumer << "," << piece << "," << bulk << "," << single << "," << single / bulk << std::endl;
+}
+
+int main() {
+	constexpr size_t kSize = 1 << 22;
+	std::vector<int> data(kSize);
+	std::iota(data.begin(), data.end(), 0);
+	auto tripled = data | transform::transform([](int x) { return x * 3; });
+
+	std::FILE* file = std::tmpfile();
+	if (file == nullptr) {
+		std::cerr << "cannot create a temporary file" << std::endl;
+		return 1;
+	}
+
+	std::cout << "consumer,piece,bulk_ns,single_ns,speedup (per element)" << std::endl;
+	for (size_t piece : { 64, 1024, 16384 }) {
+		double single = measure([&] {
+			std::rewind(file);
+			for_each::for_each(data, [file](const int& x) { std::fwrite(&x, sizeof(x), 1, file); });
+			return size_t(std::ftell(file));
+		}, kSize);
+		double bulk = measure([&] {
+			std::rewind(file);
+			for_each::for_each(data | chunk::chunk(piece), [file](auto part) { std::fwrite(&*part.begin(), sizeof(int), part.size(), file); });
+			return size_t(std::ftell(file));
+		}, kSize);
+		report("fwrite", piece, bulk, single);
+
+		single = measure([&] {
+			std::vector<int> out;
+			for_each::for_each(data, [&out](int x) { out.push_back(x); });
+			return out.size();
+		}, kSize);
+		bulk = measure([&] {
+			std::vector<int> out;
+			for_each::for_each(data | chunk::chunk(piece), [&out](auto part) { out.insert(out.end(), part.begin(), part.end()); });
+			return out.size();
+		}, kSize);
+		report("vector insert", piece, bulk, single);
+
+		single = measure([&] {
+			std::vector<int> out;
+			for_each::for_each(tripled, [&out](int x) { out.push_back(x); });
+			return out.size();
+		}, kSize);
+		bulk = measure([&] {
+			std::vector<int> out;
+			for_each::for_each(tripled | chunk::chunk(piece), [&out](auto part) { out.insert(out.end(), part.begin(), part.end()); });
+			return out.size();
+		}, kSize);
+		report("transform|vector insert", piece, bulk, single);
+	}
+	std::fclose(file);
+	return 0;
+}
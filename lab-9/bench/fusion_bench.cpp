@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "adapters.cpp"
+
+// Runs the same pipelines three ways over a large vector: a hand-written loop, the
+// fused for_each, and range-for through the nested iterators. The fused loop should
+// match the hand-written one.
+
+static volatile int64_t sink;
+
+template<typename Run>
+static double measure(Run run, size_t elements) {
+	constexpr int kRepeats = 10;
+	double best = 1e300;
+	for (int r = 0; r < kRepeats; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		sink = run();
+		std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+		best = std::min(best, time.count());
+	}
+	return best / double(elements);
+}
+
+template<typename Hand, typename Pipeline>
+static void report(const char* name, size_t elements, Hand hand, const Pipeline& pipeline) {
+	double handNs = measure(hand, elements);
+	double fusedNs = measure([&pipeline] {
+		int64_t sum = 0;
+		for_each::for_each(pipeline, [&sum](int64_t x) { sum += x; });
+		return sum;
+	}, elements);
+	double iteratorNs = measure([&pipeline] {
+		int64_t sum = 0;
+		for (int64_t x : pipeline) {
+			sum += x;
+		}
+		return sum;
+	}, elements);
+	std::cout << name << "," << handNs << "," << fusedNs << "," << iteratorNs << std::endl;
+}
+
+int main() {
+	constexpr size_t kSize = 10000000;
+	std::vector<int> numbers(kSize);
+	for (size_t i = 0; i < kSize; ++i) {
+		numbers[i] = int(i * 2654435761u % 1000);
+	}
+
+	std::cout << "pipeline,hand_ns,fused_ns,iterators_ns (per element)" << std::endl;
+
+	report("transform", kSize, [&numbers] {
+		int64_t sum = 0;
+		for (int x : numbers) {
+			sum += int64_t(x) * 3 + 1;
+		}
+		return sum;
+	}, numbers | transform::transform([](int x) { return int64_t(x) * 3 + 1; }));
+
+	report("filter|transform", kSize, [&numbers] {
+		int64_t sum = 0;
+		for (int x : numbers) {
+			if (x % 2 == 0) {
+				sum += int64_t(x) * x;
+			}
+		}
+		return sum;
+	}, numbers | filter::filter([](int x) { return x % 2 == 0; }) | transform::transform([](int x) { return int64_t(x) * x; }));
+
+	report("drop|filter|transform|take", kSize, [&numbers] {
+		int64_t sum = 0;
+		size_t taken = 0;
+		for (size_t i = 100; i < numbers.size() && taken < kSize / 4; ++i) {
+			if (numbers[i] > 500) {
+				sum += numbers[i] - 500;
+				++taken;
+			}
+		}
+		return sum;
+	}, numbers | drop::drop(100) | filter::filter([](int x) { return x > 500; })
+		| transform::transform([](int x) { return int64_t(x) - 500; }) | take::take(kSize / 4));
+	return 0;
+}
@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "adapters.cpp"
+
+// Drops k keys from a million entries with keys(), against scanning the list of keys
+// for every entry as keys() used to.
+
+static volatile int64_t sink;
+
+template<typename Run>
+static double measure(Run run, size_t elements) {
+	constexpr int kRepeats = 5;
+	double best = 1e300;
+	for (int r = 0; r < kRepeats; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		sink = run();
+		std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+		best = std::min(best, time.count());
+	}
+	return best / double(elements);
+}
+
+int main() {
+	constexpr size_t kEntries = 1000000;
+	std::vector<std::pair<int, int>> entries(kEntries);
+	for (size_t i = 0; i < kEntries; ++i) {
+		entries[i] = { int(i * 2654435761u % kEntries), int(i) };
+	}
+
+	std::cout << "k,keys_ns,linear_scan_ns (per entry)" << std::endl;
+	for (size_t k = 1; k <= 4096; k *= 4) {
+		std::vector<int> dropped(k);
+		for (size_t i = 0; i < k; ++i) {
+			dropped[i] = int(i * 7919 % kEntries);
+		}
+
+		double hashed = measure([&] {
+			return int64_t(count::count(entries | keys::keys(dropped)));
+		}, kEntries);
+		double linear = measure([&] {
+			return int64_t(count::count(entries | keys::keys([&dropped](const std::pair<int, int>& entry) {
+				return std::find(dropped.begin(), dropped.end(), entry.first) != dropped.end();
+			})));
+		}, kEntries);
+		std::cout << k << "," << hashed << "," << linear << std::endl;
+	}
+	return 0;
+}
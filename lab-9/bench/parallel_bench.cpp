@@ -0,0 +1,55 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "adapters.cpp"
+
+// A CPU-heavy transform over a large vector, reduced and collected sequentially and
+// with execution::par on growing thread counts.
+
+static volatile int64_t sink;
+
+static int64_t heavy(int x) {
+	uint64_t value = uint64_t(x);
+	for (int i = 0; i < 200; ++i) {
+		value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+	}
+	return int64_t(value >> 33);
+}
+
+template<typename Run>
+static double measure(Run run) {
+	constexpr int kRepeats = 3;
+	double best = 1e300;
+	for (int r = 0; r < kRepeats; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		run();
+		std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+		best = std::min(best, time.count());
+	}
+	return best;
+}
+
+int main() {
+	constexpr size_t kSize = 4000000;
+	std::vector<int> numbers(kSize);
+	for (size_t i = 0; i < kSize; ++i) {
+		numbers[i] = int(i);
+	}
+	auto pipeline = numbers | filter::filter([](int x) { return x % 4 != 0; }) | transform::transform(&heavy);
+
+	double reduceSerial = measure([&pipeline] { sink = reduce::reduce(pipeline, int64_t(0), std::plus<int64_t>()); });
+	double collectSerial = measure([&pipeline] { sink = int64_t(collect::collect(pipeline).size()); });
+	std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+	std::cout << "threads,reduce_ms,reduce_speedup,collect_ms,collect_speedup" << std::endl;
+	std::cout << "seq," << reduceSerial << ",1," << collectSerial << ",1" << std::endl;
+	for (size_t threads : { 1, 2, 4, 8 }) {
+		execution::parallel_policy policy{ threads };
+		double reduceParallel = measure([&] { sink = reduce::reduce(policy, pipeline, int64_t(0), std::plus<int64_t>()); });
+		double collectParallel = measure([&] { sink = int64_t(collect::collect(policy, pipeline).size()); });
+		std::cout << threads << "," << reduceParallel << "," << reduceSerial / reduceParallel << "," << collectParallel << ","
+			<< collectSerial / collectParallel << std::endl;
+	}
+	return 0;
+}
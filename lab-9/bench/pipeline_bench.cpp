@@ -0,0 +1,53 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "adapters.cpp"
+
+// Builds a five-stage pipeline over vectors of growing size. Building only stores a
+// reference and the stage arguments, so its cost must not grow with the input; the
+// pass over the elements is timed separately for comparison.
+
+static volatile int64_t sink;
+static const void* volatile escape;
+
+template<typename Container>
+static auto pipeline(Container& numbers) {
+	return numbers
+		| filter::filter([](int x) { return x % 3 != 0; })
+		| transform::transform([](int x) { return int64_t(x) * x; })
+		| drop::drop(10)
+		| take::take(numbers.size() / 2)
+		| filter::filter([](int64_t x) { return x % 2 == 0; });
+}
+
+int main() {
+	constexpr size_t kBuilds = 100000;
+	std::cout << "elements,setup_ns,iterate_ns_per_element" << std::endl;
+	for (size_t size = 1000; size <= 10000000; size *= 10) {
+		std::vector<int> numbers(size);
+		for (size_t i = 0; i < size; ++i) {
+			numbers[i] = int(i);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < kBuilds; ++i) {
+			auto view = pipeline(numbers);
+			escape = &view;
+		}
+		auto built = std::chrono::steady_clock::now();
+
+		int64_t sum = 0;
+		for (int64_t x : pipeline(numbers)) {
+			sum += x;
+		}
+		sink = sum;
+		auto iterated = std::chrono::steady_clock::now();
+
+		std::chrono::duration<double, std::nano> setup = built - start;
+		std::chrono::duration<double, std::nano> pass = iterated - built;
+		std::cout << size << "," << setup.count() / kBuilds << "," << pass.count() / double(size) << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,114 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#if __has_include(<sys/resource.h>)
+#include <sys/resource.h>
+#endif
+
+#include "adapters.cpp"
+
+// Throughput of pipelines over the streaming sources, on a generated text file of
+// numbers, one per line, of the size given in MiB (default 256; pass a few thousand
+// for multi-GB files). The same count is taken by reading the whole file into a string
+// first, the way a container-only pipeline would have to.
+//
+// max_rss_mb is the peak resident memory of the process so far, so cases run from the
+// leanest up. The lines source and the generator hold a line at a time. The pages of a
+// mapped file count as resident while mapped, but they are page cache that the kernel
+// evicts under pressure, unlike the string, which is why larger-than-memory files can
+// still be scanned through bytes().
+
+static volatile size_t sink;
+
+template<typename Run>
+static double measure(Run run, double megabytes) {
+	constexpr int kRepeats = 3;
+	double best = 1e300;
+	for (int r = 0; r < kRepeats; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		sink = run();
+		std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+		best = std::min(best, time.count());
+	}
+	return megabytes / best;
+}
+
+static double max_rss_mb() {
+#if __has_include(<sys/resource.h>)
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	return double(usage.ru_maxrss) / 1024;
+#else
+	return 0;
+#endif
+}
+
+static void report(const char* source, const char* pipeline, double throughput) {
+	std::cout << source << "," << pipeline << "," << throughput << "," << max_rss_mb() << std::endl;
+}
+
+static void generate(const std::string& path, size_t bytes) {
+	std::ofstream file(path, std::ios::binary);
+	std::mt19937 generator(1);
+	std::string buffer;
+	for (size_t written = 0; written < bytes; written += buffer.size()) {
+		buffer.clear();
+		for (int i = 0; i < 4096; ++i) {
+			buffer += std::to_string(generator() % 1000000);
+			buffer += '\n';
+		}
+		file.write(buffer.data(), std::streamsize(buffer.size()));
+	}
+}
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+static generator::generator<std::string> read_lines(std::string path) {
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line)) {
+		co_yield line;
+	}
+}
+#endif
+
+int main(int argc, char* argv[]) {
+	size_t mebibytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+	std::string path = (std::filesystem::temp_directory_path() / "sources_bench.txt").string();
+	generate(path, mebibytes << 20);
+	double megabytes = double(std::filesystem::file_size(path)) / (1 << 20);
+
+	auto parse = [](const std::string& line) { return std::strtol(line.c_str(), nullptr, 10); };
+	auto small = [](long x) { return x < 1000; };
+	auto newline = [](char c) { return c == '\n'; };
+
+	std::cout << "source,pipeline,mb_per_s,max_rss_mb" << std::endl;
+	report("lines", "transform|filter|count", measure([&] {
+		return count::count(lines::lines(path) | transform::transform(parse) | filter::filter(small));
+	}, megabytes));
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+	report("generator", "transform|filter|count", measure([&] {
+		return count::count(read_lines(path) | transform::transform(parse) | filter::filter(small));
+	}, megabytes));
+#endif
+#if __has_include(<sys/mman.h>)
+	report("bytes", "filter|count", measure([&] {
+		return count::count(bytes::bytes(path) | filter::filter(newline));
+	}, megabytes));
+#endif
+	report("string", "filter|count", measure([&] {
+		std::ifstream file(path, std::ios::binary);
+		std::ostringstream contents;
+		contents << file.rdbuf();
+		return count::count(contents.str() | filter::filter(newline));
+	}, megabytes));
+
+	std::filesystem::remove(path);
+	return 0;
+}
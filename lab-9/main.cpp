@@ -1,13 +1,20 @@
 #include <iostream>
 #include <vector>
 #include <map>
-#include <adapters.h>
+#include <string>
+#include "adapters.cpp"
 
 int main() {
-	std::vector<int> test = { 1, 4, 6, 2, 7, 4, 1, 4 };
-	auto removed = v1 | values({ 3, 2, 4 });
+	std::map<int, std::string> v1 = { { 1, "one" }, { 2, "two" }, { 3, "three" }, { 4, "four" } };
+	auto removed = v1 | values::values({ std::string("two"), std::string("four") });
 	for (auto i : removed) {
 		std::cout << i.first << ' ' << i.second << std::endl;
 	}
+
+	std::vector<int> test = { 1, 4, 6, 2, 7, 4, 1, 4 };
+	for (int i : test | filter::filter([](int i) { return i % 2 == 0; }) | transform::transform([](int i) { return i * i; })) {
+		std::cout << i << ' ';
+	}
+	std::cout << std::endl;
 	return 0;
-}
\ No newline at end of file
+}
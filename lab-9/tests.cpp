@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 #include "adapters.cpp"
+#include <deque>
+#include <fstream>
 #include <map>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include <list>
@@ -26,13 +32,13 @@ TEST(DropAdapterTest, DropElementsFromList) {
 }
 
 TEST(DropAdapterTest, DropZeroElements) {
-    std::array<float, 4> floats = { 1.1, 2.2, 3.3, 4.4 };
+    std::vector<float> floats = { 1.1, 2.2, 3.3, 4.4 };
 
     drop::drop_helper helper(0);
     auto result = floats | drop::drop(helper);
 
-    std::array<float, 4> expected = { 1.1, 2.2, 3.3, 4.4 };
-    ASSERT_EQ(std::array<float, 4>(result.begin(), result.end()), expected);
+    std::vector<float> expected = { 1.1, 2.2, 3.3, 4.4 };
+    ASSERT_EQ(std::vector<float>(result.begin(), result.end()), expected);
 }
 
 TEST(DropAdapterTest, DropTooManyElements) {
@@ -146,7 +152,7 @@ TEST(TransformAdapterTest, TransformListWithFunctionObject) {
     Square square;
     auto result = floats | transform::transform(square);
 
-    std::list<float> expected = { 1.21, 4.84, 10.89, 19.36, 30.25 };
+    std::list<float> expected = { 1.1f * 1.1f, 2.2f * 2.2f, 3.3f * 3.3f, 4.4f * 4.4f, 5.5f * 5.5f };
     ASSERT_EQ(std::list<float>(result.begin(), result.end()), expected);
 }
 
@@ -186,7 +192,7 @@ TEST(KeysAdapterTest, KeysFromMap) {
         {2, "two"}
     };
 
-    ASSERT_EQ(std::vector<std::pair<int, std::string>>(result.begin(), result.end()), expected);
+    ASSERT_EQ((std::vector<std::pair<int, std::string>>(result.begin(), result.end())), expected);
 }
 
 TEST(KeysAdapterTest, KeysFromUnorderedMap) {
@@ -202,7 +208,7 @@ TEST(KeysAdapterTest, KeysFromUnorderedMap) {
         {2, "two"}
     };
 
-    ASSERT_EQ(std::vector<std::pair<int, std::string>>(result.begin(), result.end()), expected);
+    ASSERT_EQ((std::vector<std::pair<int, std::string>>(result.begin(), result.end())), expected);
 }
 
 TEST(KeysAdapterTest, KeysWithLambdaMap) {
@@ -219,7 +225,7 @@ TEST(KeysAdapterTest, KeysWithLambdaMap) {
         {3, "three"}
     };
 
-    ASSERT_EQ(std::vector<std::pair<int, std::string>>(result.begin(), result.end()), expected);
+    ASSERT_EQ((std::vector<std::pair<int, std::string>>(result.begin(), result.end())), expected);
 }
 
 TEST(KeysAdapterTest, KeysWithLambdaUnorderedMap) {
@@ -231,31 +237,47 @@ TEST(KeysAdapterTest, KeysWithLambdaUnorderedMap) {
 
     auto result = myUnorderedMap | keys::keys([](const auto& pair) { return pair.first % 2 == 0; });
 
-    std::vector<std::pair<int, std::string>> expected = {
+    std::map<int, std::string> expected = {
         {1, "one"},
         {3, "three"}
     };
 
-    ASSERT_EQ(std::vector<std::pair<int, std::string>>(result.begin(), result.end()), expected);
+    ASSERT_EQ((std::map<int, std::string>(result.begin(), result.end())), expected);
 }
 
 
 
-TEST(ValuesAdapterTest, ValuesWithLambdaMap) {
+TEST(ValuesAdapterTest, ValuesFromMap) {
     std::map<int, std::string> myMap = {
         {1, "one"},
         {2, "two"},
         {3, "three"}
     };
 
-    auto result = myMap | values::values([](const auto& pair) { return pair.second.length() > 3; });
+    auto result = myMap | values::values({ std::string("one"), std::string("three") });
 
     std::vector<std::pair<int, std::string>> expected = {
+        {2, "two"}
+    };
+
+    ASSERT_EQ((std::vector<std::pair<int, std::string>>(result.begin(), result.end())), expected);
+}
+
+TEST(ValuesAdapterTest, ValuesWithLambdaMap) {
+    std::map<int, std::string> myMap = {
+        {1, "one"},
         {2, "two"},
         {3, "three"}
     };
 
-    ASSERT_EQ(std::vector<std::pair<int, std::string>>(result.begin(), result.end()), expected);
+    auto result = myMap | values::values([](const auto& pair) { return pair.second.length() > 3; });
+
+    std::vector<std::pair<int, std::string>> expected = {
+        {1, "one"},
+        {2, "two"}
+    };
+
+    ASSERT_EQ((std::vector<std::pair<int, std::string>>(result.begin(), result.end())), expected);
 }
 
 TEST(ValuesAdapterTest, ValuesWithLambdaUnorderedMap) {
@@ -267,40 +289,48 @@ TEST(ValuesAdapterTest, ValuesWithLambdaUnorderedMap) {
 
     auto result = myUnorderedMap | values::values([](const auto& pair) { return pair.second.length() > 3; });
 
-    std::vector<std::pair<int, std::string>> expected = {
-        {2, "two"},
-        {3, "three"}
+    std::map<int, std::string> expected = {
+        {1, "one"},
+        {2, "two"}
     };
 
-    ASSERT_EQ(std::vector<std::pair<int, std::string>>(result.begin(), result.end()), expected);
+    ASSERT_EQ((std::map<int, std::string>(result.begin(), result.end())), expected);
 }
 
-TEST(ValuesAdapterTest, ValuesWithLambdaMap) {
+TEST(ValuesAdapterTest, ValuesByKeyWithLambdaMap) {
     std::map<int, std::string> myMap = {
         {1, "one"},
         {2, "two"},
         {3, "three"}
     };
 
-    auto result = myMap | values::values([](const auto& pair) { return pair.first % 2 == 0; });
+    auto result = myMap | values::values([](const auto& pair) { return pair.first % 2 != 0; });
 
     std::vector<std::string> expected = { "two" };
 
-    ASSERT_EQ(std::vector<std::string>(result.begin(), result.end()), expected);
+    std::vector<std::string> actual;
+    for (const auto& pair : result) {
+        actual.push_back(pair.second);
+    }
+    ASSERT_EQ(actual, expected);
 }
 
-TEST(ValuesAdapterTest, ValuesWithLambdaUnorderedMap) {
+TEST(ValuesAdapterTest, ValuesByKeyWithLambdaUnorderedMap) {
     std::unordered_map<int, std::string> myUnorderedMap = {
         {1, "one"},
         {2, "two"},
         {3, "three"}
     };
 
-    auto result = myUnorderedMap | values::values([](const auto& pair) { return pair.first % 2 == 0; });
+    auto result = myUnorderedMap | values::values([](const auto& pair) { return pair.first % 2 != 0; });
 
     std::vector<std::string> expected = { "two" };
 
-    ASSERT_EQ(std::vector<std::string>(result.begin(), result.end()), expected);
+    std::vector<std::string> actual;
+    for (const auto& pair : result) {
+        actual.push_back(pair.second);
+    }
+    ASSERT_EQ(actual, expected);
 }
 
 
@@ -311,7 +341,7 @@ TEST(ReverseAdapterTest, ReverseVector) {
     auto reversed = vec | reverse::reverse();
 
     std::vector<int> expected = { 5, 4, 3, 2, 1 };
-    ASSERT_EQ(reversed.container, expected);
+    ASSERT_EQ(std::vector<int>(reversed.begin(), reversed.end()), expected);
 }
 
 TEST(ReverseAdapterTest, ReverseList) {
@@ -319,58 +349,50 @@ TEST(ReverseAdapterTest, ReverseList) {
     auto reversed = lst | reverse::reverse();
 
     std::list<int> expected = { 5, 4, 3, 2, 1 };
-    ASSERT_EQ(reversed.container, expected);
-}
-
-int main(int argc, char** argv) {
-    ::testing::InitGoogleTest(&argc, argv);
-    return RUN_ALL_TESTS();
+    ASSERT_EQ(std::list<int>(reversed.begin(), reversed.end()), expected);
 }
 
-
-
-
 TEST(FilterAdapterTest, FilterVector) {
     std::vector<int> vec = { 1, 2, 3, 4, 5 };
-    auto filtered = vec | filter([](int x) { return x % 2 == 0; });
+    auto filtered = vec | filter::filter([](int x) { return x % 2 == 0; });
 
-    auto expected = { 2, 4 };
-    ASSERT_EQ(filtered.container, expected);
+    std::vector<int> expected = { 2, 4 };
+    ASSERT_EQ(std::vector<int>(filtered.begin(), filtered.end()), expected);
 }
 
 TEST(FilterAdapterTest, FilterList) {
     std::list<int> lst = { 1, 2, 3, 4, 5 };
-    auto filtered = lst | filter([](int x) { return x % 2 == 0; });
+    auto filtered = lst | filter::filter([](int x) { return x % 2 == 0; });
 
-    auto expected = { 2, 4 };
-    ASSERT_EQ(filtered.container, expected);
+    std::vector<int> expected = { 2, 4 };
+    ASSERT_EQ(std::vector<int>(filtered.begin(), filtered.end()), expected);
 }
 
 TEST(FilterAdapterTest, FilterEmptyContainer) {
     std::vector<int> vec;
-    auto filtered = vec | filter([](int x) { return x % 2 == 0; });
+    auto filtered = vec | filter::filter([](int x) { return x % 2 == 0; });
 
-    ASSERT_TRUE(filtered.container.empty());
+    ASSERT_EQ(filtered.begin(), filtered.end());
 }
 
 TEST(FilterAdapterTest, FilterAllElements) {
     std::vector<int> vec = { 2, 4, 6, 8, 10 };
-    auto filtered = vec | filter([](int x) { return x % 2 == 0; });
+    auto filtered = vec | filter::filter([](int x) { return x % 2 == 0; });
 
-    ASSERT_EQ(filtered.container, vec);
+    ASSERT_EQ(std::vector<int>(filtered.begin(), filtered.end()), vec);
 }
 
 TEST(FilterAdapterTest, FilterNoElements) {
     std::vector<int> vec = { 1, 3, 5, 7, 9 };
-    auto filtered = vec | filter([](int x) { return x % 2 == 0; });
+    auto filtered = vec | filter::filter([](int x) { return x % 2 == 0; });
 
-    ASSERT_TRUE(filtered.container.empty());
+    ASSERT_EQ(filtered.begin(), filtered.end());
 }
 
 TEST(FilterAdapterTest, FilterUsingLambdaWithState) {
     std::vector<int> vec = { 1, 2, 3, 4, 5 };
     int count = 0;
-    auto filtered = vec | filter([&count](int x) {
+    auto filtered = vec | filter::filter([&count](int x) {
         if (x % 2 == 0) {
             count++;
             return true;
@@ -378,13 +400,609 @@ TEST(FilterAdapterTest, FilterUsingLambdaWithState) {
         return false;
         });
 
-    auto expected = { 2, 4 };
-    ASSERT_EQ(filtered.container, expected);
+    std::vector<int> actual;
+    for (int x : filtered) {
+        actual.push_back(x);
+    }
+    std::vector<int> expected = { 2, 4 };
+    ASSERT_EQ(actual, expected);
     ASSERT_EQ(count, 2);
 }
 
 
 
+TEST(ViewTest, RefersToContainer) {
+    std::vector<int> vec = { 1, 2, 3 };
+    auto view = vec | transform::transform([](int x) { return x * 10; });
+
+    vec[0] = 5;
+    vec.push_back(4);
+
+    std::vector<int> expected = { 50, 20, 30, 40 };
+    ASSERT_EQ(std::vector<int>(view.begin(), view.end()), expected);
+}
+
+TEST(ViewTest, WritesThroughToContainer) {
+    std::vector<int> vec = { 1, 2, 3, 4 };
+    for (int& x : vec | drop::drop(1) | take::take(2)) {
+        x = 0;
+    }
+
+    std::vector<int> expected = { 1, 0, 0, 4 };
+    ASSERT_EQ(vec, expected);
+}
+
+TEST(ViewTest, OwnsTemporaryContainer) {
+    auto view = std::vector<int>{ 1, 2, 3, 4, 5 } | filter::filter([](int x) { return x % 2 != 0; });
+
+    std::vector<int> expected = { 1, 3, 5 };
+    ASSERT_EQ(std::vector<int>(view.begin(), view.end()), expected);
+}
+
+TEST(ViewTest, ComposesStages) {
+    std::vector<int> vec = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    auto odd = vec | filter::filter([](int x) { return x % 2 != 0; });
+    auto squares = odd | transform::transform([](int x) { return x * x; });
+    auto result = squares | drop::drop(1) | take::take(3);
+
+    std::vector<int> expected = { 9, 25, 49 };
+    ASSERT_EQ(std::vector<int>(result.begin(), result.end()), expected);
+}
+
+TEST(ForEachTest, RunsPipeline) {
+    std::list<int> lst = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    std::vector<int> result;
+    for_each::for_each(lst | drop::drop(1) | filter::filter([](int x) { return x % 2 == 0; })
+        | transform::transform([](int x) { return x * x; }) | take::take(3), [&result](int x) { result.push_back(x); });
+
+    std::vector<int> expected = { 4, 16, 36 };
+    ASSERT_EQ(result, expected);
+}
+
+TEST(ForEachTest, CallsEachFunctionOncePerElement) {
+    std::vector<int> vec = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    int conditions = 0;
+    int transforms = 0;
+    auto pipeline = vec
+        | filter::filter([&conditions](int x) { ++conditions; return x % 2 == 0; })
+        | transform::transform([&transforms](int x) { ++transforms; return x + 1; })
+        | take::take(2);
+
+    int sum = 0;
+    for_each::for_each(pipeline, [&sum](int x) { sum += x; });
+
+    ASSERT_EQ(sum, 3 + 5);
+    ASSERT_EQ(conditions, 4);
+    ASSERT_EQ(transforms, 2);
+}
+
+TEST(ForEachTest, MatchesIterators) {
+    std::vector<int> vec(100);
+    for (int i = 0; i < 100; ++i) {
+        vec[i] = i * 7 % 31;
+    }
+    auto pipeline = vec | drop::drop(5) | filter::filter([](int x) { return x > 10; }) | take::take(40) | drop::drop(3);
+
+    std::vector<int> pushed;
+    for_each::for_each(pipeline, [&pushed](int x) { pushed.push_back(x); });
+    ASSERT_EQ(pushed, std::vector<int>(pipeline.begin(), pipeline.end()));
+}
+
+TEST(IteratorCategoryTest, PropagatesFromContainer) {
+    std::vector<int> vec = { 1, 2, 3 };
+    std::list<int> lst = { 1, 2, 3 };
+    auto square = [](int x) { return x * x; };
+    auto even = [](int x) { return x % 2 == 0; };
+
+    using vector_transform = decltype((vec | transform::transform(square)).begin());
+    using list_transform = decltype((lst | transform::transform(square)).begin());
+    using vector_filter = decltype((vec | filter::filter(even)).begin());
+    using vector_take = decltype((vec | take::take(2)).begin());
+    using list_take = decltype((lst | take::take(2)).begin());
+
+    static_assert(std::is_same<std::iterator_traits<vector_transform>::iterator_category, std::random_access_iterator_tag>::value, "");
+    static_assert(std::is_same<std::iterator_traits<list_transform>::iterator_category, std::bidirectional_iterator_tag>::value, "");
+    static_assert(std::is_same<std::iterator_traits<vector_filter>::iterator_category, std::bidirectional_iterator_tag>::value, "");
+    static_assert(std::is_same<vector_take, std::vector<int>::iterator>::value, "");
+    static_assert(std::is_same<std::iterator_traits<list_take>::iterator_category, std::forward_iterator_tag>::value, "");
+}
+
+TEST(IteratorCategoryTest, RandomAccessPipeline) {
+    std::vector<int> vec(100);
+    std::iota(vec.begin(), vec.end(), 0);
+    auto result = vec | transform::transform([](int x) { return x * 2; }) | drop::drop(10) | take::take(20);
+
+    ASSERT_EQ(result.size(), 20u);
+    ASSERT_EQ(std::distance(result.begin(), result.end()), 20);
+    ASSERT_EQ(result.begin()[5], 30);
+    ASSERT_EQ(*(result.end() - 1), 58);
+}
+
+TEST(IteratorCategoryTest, Sizes) {
+    std::list<int> lst = { 1, 2, 3, 4, 5 };
+
+    ASSERT_EQ((lst | drop::drop(2)).size(), 3u);
+    ASSERT_EQ((lst | drop::drop(7)).size(), 0u);
+    ASSERT_EQ((lst | take::take(2)).size(), 2u);
+    ASSERT_EQ((lst | take::take(9)).size(), 5u);
+    ASSERT_EQ((lst | reverse::reverse() | transform::transform([](int x) { return -x; })).size(), 5u);
+}
+
+TEST(IteratorCategoryTest, ReverseAdapters) {
+    std::vector<int> vec = { 1, 2, 3, 4, 5, 6 };
+    auto result = vec | filter::filter([](int x) { return x % 2 == 0; }) | transform::transform([](int x) { return x * 10; })
+        | reverse::reverse();
+
+    std::vector<int> expected = { 60, 40, 20 };
+    ASSERT_EQ(std::vector<int>(result.begin(), result.end()), expected);
+}
+
+TEST(TerminalTest, Sequential) {
+    std::list<int> lst = { 1, 2, 3, 4, 5, 6 };
+    auto pipeline = lst | filter::filter([](int x) { return x % 2 == 0; }) | transform::transform([](int x) { return x * x; });
+
+    ASSERT_EQ(reduce::reduce(pipeline, 0, [](int a, int b) { return a + b; }), 4 + 16 + 36);
+    ASSERT_EQ(collect::collect(pipeline), (std::vector<int>{ 4, 16, 36 }));
+    ASSERT_EQ(count::count(pipeline), 3u);
+    ASSERT_EQ(count::count(lst | drop::drop(2)), 4u);
+}
+
+TEST(TerminalTest, ParallelMatchesSequential) {
+    std::vector<int> vec(100000);
+    std::iota(vec.begin(), vec.end(), 0);
+    execution::parallel_policy policy{ 4, 1000 };
+    auto pipeline = vec | filter::filter([](int x) { return x % 3 != 0; }) | transform::transform([](int x) { return int64_t(x) * x; });
+
+    ASSERT_EQ(reduce::reduce(policy, pipeline, int64_t(0), std::plus<int64_t>()),
+        reduce::reduce(pipeline, int64_t(0), std::plus<int64_t>()));
+    ASSERT_EQ(collect::collect(policy, pipeline), collect::collect(pipeline));
+    ASSERT_EQ(count::count(policy, pipeline), count::count(pipeline));
+
+    std::atomic<int64_t> sum{ 0 };
+    for_each::for_each(policy, pipeline, [&sum](int64_t x) { sum += x; });
+    ASSERT_EQ(sum.load(), reduce::reduce(pipeline, int64_t(0), std::plus<int64_t>()));
+}
+
+TEST(TerminalTest, ParallelSlicesRandomAccessStages) {
+    std::vector<int> vec(50000);
+    std::iota(vec.begin(), vec.end(), 0);
+    execution::parallel_policy policy{ 3, 100 };
+    auto pipeline = vec | drop::drop(7) | take::take(40000) | reverse::reverse() | filter::filter([](int x) { return x % 2 == 0; });
+
+    static_assert(detail::is_sliceable_v<decltype(pipeline)>, "");
+    ASSERT_EQ(collect::collect(policy, pipeline), std::vector<int>(pipeline.begin(), pipeline.end()));
+}
+
+TEST(TerminalTest, ParallelFallsBackToSequential) {
+    std::list<int> lst(1000, 1);
+    auto pipeline = std::vector<int>(1000, 2) | filter::filter([](int x) { return x > 0; }) | take::take(10);
+
+    static_assert(!detail::is_sliceable_v<decltype(pipeline)>, "");
+    ASSERT_EQ(reduce::reduce(execution::par, lst, 0, std::plus<int>()), 1000);
+    ASSERT_EQ(reduce::reduce(execution::par, pipeline, 0, std::plus<int>()), 20);
+}
+
+TEST(TerminalTest, ParallelRethrows) {
+    std::vector<int> vec(10000, 1);
+    vec[7777] = -1;
+    auto pipeline = vec | transform::transform([](int x) {
+        if (x < 0) {
+            throw std::runtime_error("negative");
+        }
+        return x;
+    });
+
+    ASSERT_THROW(reduce::reduce(execution::parallel_policy{ 4, 100 }, pipeline, 0, std::plus<int>()), std::runtime_error);
+}
+
+TEST(KeysAdapterTest, KeysFromRange) {
+    std::vector<std::pair<int, int>> entries;
+    for (int i = 0; i < 100; ++i) {
+        entries.emplace_back(i, i * i);
+    }
+    std::vector<int> dropped;
+    for (int i = 0; i < 100; i += 3) {
+        dropped.push_back(i);
+    }
+
+    auto result = entries | keys::keys(dropped);
+
+    ASSERT_EQ(count::count(result), 66u);
+    for (const auto& entry : result) {
+        ASSERT_NE(entry.first % 3, 0);
+    }
+}
+
+TEST(KeysAdapterTest, KeysFromStringLiterals) {
+    std::map<std::string, int> myMap = {
+        {"one", 1},
+        {"two", 2},
+        {"three", 3}
+    };
+
+    auto result = myMap | keys::keys({ "one", "three" });
+
+    std::vector<std::pair<const std::string, int>> expected = {
+        {"two", 2}
+    };
+    ASSERT_EQ((std::vector<std::pair<const std::string, int>>(result.begin(), result.end())), expected);
+}
+
+TEST(KeysAdapterTest, KeysWithoutHash) {
+    std::map<std::pair<int, int>, int> myMap;
+    std::vector<std::pair<int, int>> dropped;
+    for (int i = 0; i < 20; ++i) {
+        myMap[{ i, -i }] = i;
+        if (i % 2 == 0) {
+            dropped.emplace_back(i, -i);
+        }
+    }
+
+    auto result = myMap | keys::keys(dropped);
+
+    ASSERT_EQ(count::count(result), 10u);
+    for (const auto& entry : result) {
+        ASSERT_EQ(entry.second % 2, 1);
+    }
+}
+
+TEST(ValuesAdapterTest, ValuesFromSet) {
+    std::unordered_map<int, int> myMap;
+    for (int i = 0; i < 50; ++i) {
+        myMap[i] = i % 10;
+    }
+    std::set<int> dropped = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    auto result = myMap | values::values(dropped);
+
+    ASSERT_EQ(count::count(result), 5u);
+    for (const auto& entry : result) {
+        ASSERT_EQ(entry.second, 9);
+    }
+}
+
+TEST(BlockTest, SelectedForContiguousArithmetic) {
+    std::vector<float> floats;
+    std::list<float> lst;
+    std::vector<std::string> strings;
+    auto half = [](float x) { return x / 2; };
+    auto empty = [](const std::string& x) { return x.empty(); };
+    auto print = [](float x) { return std::to_string(x); };
+
+    static_assert(detail::is_blocked_v<decltype(floats | transform::transform(half))>, "");
+    static_assert(!detail::is_blocked_v<decltype(lst | transform::transform(half))>, "");
+    static_assert(!detail::is_blocked_v<decltype(strings | filter::filter(empty))>, "");
+    static_assert(!detail::is_blocked_v<decltype(floats | transform::transform(print))>, "");
+}
+
+TEST(BlockTest, CollectMatchesIterators) {
+    std::vector<int> ints(1000);
+    std::iota(ints.begin(), ints.end(), -300);
+    std::vector<double> doubles(ints.begin(), ints.end());
+
+    auto intPipeline = ints | filter::filter([](int x) { return x % 3 == 0; }) | transform::transform([](int x) { return x * 2 + 1; })
+        | filter::filter([](int x) { return x > 0; });
+    auto doublePipeline = doubles | transform::transform([](double x) { return x * 0.5; }) | filter::filter([](double x) { return x < 100; });
+
+    ASSERT_EQ(collect::collect(intPipeline), std::vector<int>(intPipeline.begin(), intPipeline.end()));
+    ASSERT_EQ(collect::collect(doublePipeline), std::vector<double>(doublePipeline.begin(), doublePipeline.end()));
+    ASSERT_EQ(collect::collect(execution::parallel_policy{ 3, 100 }, intPipeline), collect::collect(intPipeline));
+}
+
+TEST(BlockTest, CallsConditionOncePerElement) {
+    std::vector<int> vec(1000, 4);
+    int calls = 0;
+    auto pipeline = vec | filter::filter([&calls](int x) { ++calls; return x > 0; });
+
+    ASSERT_EQ(collect::collect(pipeline).size(), 1000u);
+    ASSERT_EQ(calls, 1000);
+}
+
+TEST(BlockTest, NonConstReferenceFunctions) {
+    std::vector<int> vec = { -2, -1, 0, 1, 2 };
+    auto mapped = vec | transform::transform([](int& x) { return x + 1; });
+    auto kept = vec | filter::filter([](int& x) { return x > 0; });
+
+    static_assert(!detail::is_blocked_v<decltype(mapped)>, "");
+    static_assert(!detail::is_blocked_v<decltype(kept)>, "");
+    ASSERT_EQ(collect::collect(mapped), (std::vector<int>{ -1, 0, 1, 2, 3 }));
+    ASSERT_EQ(collect::collect(kept), (std::vector<int>{ 1, 2 }));
+    ASSERT_EQ(collect::collect(execution::parallel_policy{ 2, 1 }, mapped), collect::collect(mapped));
+}
+
+TEST(ChunkTest, SplitsIntoPieces) {
+    std::vector<int> vec = { 1, 2, 3, 4, 5, 6, 7 };
+    std::vector<std::vector<int>> pieces;
+    for (auto piece : vec | chunk::chunk(3)) {
+        pieces.emplace_back(piece.begin(), piece.end());
+    }
+
+    std::vector<std::vector<int>> expected = { { 1, 2, 3 }, { 4, 5, 6 }, { 7 } };
+    ASSERT_EQ(pieces, expected);
+    ASSERT_EQ((vec | chunk::chunk(3)).size(), 3u);
+    ASSERT_EQ((vec | chunk::chunk(7)).size(), 1u);
+    ASSERT_EQ((std::vector<int>() | chunk::chunk(3)).size(), 0u);
+}
+
+TEST(ChunkTest, PiecesReferToTheSource) {
+    std::vector<int> vec = { 1, 2, 3, 4, 5 };
+    auto pieces = vec | chunk::chunk(2);
+
+    ASSERT_EQ(&*(*pieces.begin()).begin(), vec.data());
+    ASSERT_EQ((*pieces.begin()).size(), 2u);
+}
+
+TEST(ChunkTest, ComposesWithOtherAdapters) {
+    std::list<int> lst = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    auto sums = lst | filter::filter([](int x) { return x % 2 == 0; }) | chunk::chunk(2)
+        | transform::transform([](auto piece) { return reduce::reduce(piece, 0, std::plus<int>()); });
+
+    ASSERT_EQ(std::vector<int>(sums.begin(), sums.end()), (std::vector<int>{ 6, 14, 10 }));
+    ASSERT_EQ(collect::collect(sums), (std::vector<int>{ 6, 14, 10 }));
+}
+
+TEST(ChunkTest, ParallelMatchesSequential) {
+    std::vector<int> vec(10001);
+    std::iota(vec.begin(), vec.end(), 0);
+    auto sizes = vec | chunk::chunk(64) | transform::transform([](auto piece) { return piece.size(); });
+
+    static_assert(detail::is_sliceable_v<decltype(sizes)>, "");
+    ASSERT_EQ(collect::collect(execution::parallel_policy{ 3, 10 }, sizes), collect::collect(sizes));
+    ASSERT_EQ(reduce::reduce(execution::parallel_policy{ 3, 10 }, sizes, size_t(0), std::plus<size_t>()), vec.size());
+}
+
+TEST(SlideTest, Windows) {
+    std::list<int> lst = { 1, 2, 3, 4, 5 };
+    std::vector<int> sums;
+    for (auto window : lst | slide::slide(3)) {
+        sums.push_back(reduce::reduce(window, 0, std::plus<int>()));
+    }
+
+    ASSERT_EQ(sums, (std::vector<int>{ 6, 9, 12 }));
+    ASSERT_EQ((lst | slide::slide(3)).size(), 3u);
+    ASSERT_EQ((lst | slide::slide(5)).size(), 1u);
+    ASSERT_EQ((lst | slide::slide(6)).size(), 0u);
+    ASSERT_EQ((lst | slide::slide(6)).begin(), (lst | slide::slide(6)).end());
+}
+
+TEST(SlideTest, PushMatchesIterators) {
+    std::vector<int> vec(100);
+    std::iota(vec.begin(), vec.end(), 0);
+    auto maxima = vec | slide::slide(4) | transform::transform([](auto window) { return *std::max_element(window.begin(), window.end()); });
+
+    ASSERT_EQ(collect::collect(maxima), std::vector<int>(maxima.begin(), maxima.end()));
+    ASSERT_EQ(collect::collect(execution::parallel_policy{ 3, 10 }, maxima), collect::collect(maxima));
+    ASSERT_EQ(count::count(maxima), 97u);
+}
+
+TEST(StrideTest, EveryNth) {
+    std::vector<int> vec = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    std::list<int> lst(vec.begin(), vec.end());
+    auto fromVector = vec | stride::stride(3);
+    auto fromList = lst | stride::stride(3);
+
+    std::vector<int> expected = { 0, 3, 6, 9 };
+    ASSERT_EQ(std::vector<int>(fromVector.begin(), fromVector.end()), expected);
+    ASSERT_EQ(std::vector<int>(fromList.begin(), fromList.end()), expected);
+    ASSERT_EQ(collect::collect(fromVector), expected);
+    ASSERT_EQ(collect::collect(fromList), expected);
+    ASSERT_EQ(fromVector.size(), 4u);
+    ASSERT_EQ((vec | stride::stride(5)).size(), 2u);
+}
+
+TEST(StrideTest, ComposesWithOtherAdapters) {
+    std::vector<int> vec(1000);
+    std::iota(vec.begin(), vec.end(), 0);
+    auto pipeline = vec | stride::stride(10) | transform::transform([](int x) { return x / 10; }) | take::take(5);
+
+    ASSERT_EQ(collect::collect(pipeline), (std::vector<int>{ 0, 1, 2, 3, 4 }));
+    ASSERT_EQ(collect::collect(execution::parallel_policy{ 3, 7 }, vec | stride::stride(10)),
+        collect::collect(vec | stride::stride(10)));
+}
+
+static std::string writeTempFile(const std::string& name, const std::string& contents) {
+    std::string path = ::testing::TempDir() + name;
+    std::ofstream(path, std::ios::binary) << contents;
+    return path;
+}
+
+TEST(LinesSourceTest, ReadsLines) {
+    std::string path = writeTempFile("lines.txt", "1\n22\n\n333\n4444");
+    auto lengths = lines::lines(path) | transform::transform([](const std::string& line) { return line.size(); });
+
+    ASSERT_EQ(collect::collect(lengths), (std::vector<size_t>{ 1, 2, 0, 3, 4 }));
+    ASSERT_EQ(std::vector<size_t>(lengths.begin(), lengths.end()), (std::vector<size_t>{ 1, 2, 0, 3, 4 }));
+}
+
+TEST(LinesSourceTest, EveryPassRereadsTheFile) {
+    std::string contents;
+    for (int i = 0; i < 1000; ++i) {
+        contents += std::to_string(i) + "\n";
+    }
+    std::string path = writeTempFile("numbers.txt", contents);
+    auto pipeline = lines::lines(path) | transform::transform([](const std::string& line) { return std::stoi(line); })
+        | filter::filter([](int x) { return x % 7 == 0; }) | take::take(3);
+
+    ASSERT_EQ(collect::collect(pipeline), (std::vector<int>{ 0, 7, 14 }));
+    ASSERT_EQ(std::vector<int>(pipeline.begin(), pipeline.end()), (std::vector<int>{ 0, 7, 14 }));
+    ASSERT_EQ(count::count(lines::lines(path)), 1000u);
+}
+
+TEST(LinesSourceTest, MissingFileThrows) {
+    ASSERT_THROW(count::count(lines::lines(::testing::TempDir() + "missing.txt")), std::runtime_error);
+}
+
+#if __has_include(<sys/mman.h>)
+TEST(BytesSourceTest, MapsFile) {
+    std::string contents;
+    for (int i = 0; i < 10000; ++i) {
+        contents += std::to_string(i) + "\n";
+    }
+    std::string path = writeTempFile("bytes.txt", contents);
+    auto file = bytes::bytes(path);
+    auto newlines = file | filter::filter([](char c) { return c == '\n'; });
+
+    ASSERT_EQ(file.size(), contents.size());
+    ASSERT_EQ(std::string(file.begin(), file.end()), contents);
+    ASSERT_EQ(count::count(newlines), 10000u);
+    ASSERT_EQ(count::count(execution::parallel_policy{ 3, 1000 }, newlines), 10000u);
+    static_assert(detail::is_blocked_v<decltype(newlines)>, "");
+    ASSERT_EQ(collect::collect(file | take::take(5)), (std::vector<char>{ '0', '\n', '1', '\n', '2' }));
+}
+
+TEST(BytesSourceTest, EmptyAndMissingFiles) {
+    ASSERT_EQ(bytes::bytes(writeTempFile("empty.txt", "")).size(), 0u);
+    ASSERT_THROW(bytes::bytes(::testing::TempDir() + "missing.bin"), std::system_error);
+}
+#endif
+
+TEST(IotaSourceTest, Bounded) {
+    auto squares = iota::iota(1, 11) | transform::transform([](int x) { return x * x; });
+
+    ASSERT_EQ(squares.size(), 10u);
+    ASSERT_EQ(reduce::reduce(squares, 0, std::plus<int>()), 385);
+    ASSERT_EQ(squares.begin()[3], 16);
+    ASSERT_EQ(iota::iota(-3, 3).size(), 6u);
+    ASSERT_EQ(iota::iota(5, 2).size(), 0u);
+    ASSERT_EQ(collect::collect(iota::iota(-2, 2) | reverse::reverse()), (std::vector<int>{ 1, 0, -1, -2 }));
+}
+
+TEST(IotaSourceTest, Unbounded) {
+    auto evens = iota::iota(0) | filter::filter([](int x) { return x % 2 == 0; }) | take::take(5);
+
+    ASSERT_EQ(collect::collect(evens), (std::vector<int>{ 0, 2, 4, 6, 8 }));
+    ASSERT_EQ(collect::collect(iota::iota(size_t(0)) | take::take(3)), (std::vector<size_t>{ 0, 1, 2 }));
+    ASSERT_EQ(collect::collect(iota::iota(int64_t(-5)) | drop::drop(3) | take::take(3)), (std::vector<int64_t>{ -2, -1, 0 }));
+}
+
+TEST(IotaSourceTest, BlocksAndParallel) {
+    auto pipeline = iota::iota(0, 100000) | transform::transform([](int x) { return x % 1000; }) | filter::filter([](int x) { return x < 10; });
+
+    static_assert(detail::is_blocked_v<decltype(pipeline)>, "");
+    ASSERT_EQ(collect::collect(pipeline), std::vector<int>(pipeline.begin(), pipeline.end()));
+    ASSERT_EQ(collect::collect(execution::parallel_policy{ 3, 1000 }, pipeline), collect::collect(pipeline));
+}
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+static generator::generator<int> naturals() {
+    for (int i = 0;; ++i) {
+        co_yield i;
+    }
+}
+
+static generator::generator<std::string> words(int failAt) {
+    for (int i = 0; i < 5; ++i) {
+        if (i == failAt) {
+            throw std::runtime_error("failed");
+        }
+        co_yield "w" + std::to_string(i);
+    }
+}
+
+TEST(GeneratorSourceTest, Endless) {
+    auto pipeline = naturals() | filter::filter([](int x) { return x % 3 == 0; }) | transform::transform([](int x) { return x * 2; })
+        | take::take(4);
+
+    ASSERT_EQ(collect::collect(pipeline), (std::vector<int>{ 0, 6, 12, 18 }));
+}
+
+TEST(GeneratorSourceTest, SinglePass) {
+    auto numbers = naturals();
+    auto first = numbers.begin();
+    ++first;
+    ++first;
+    ASSERT_EQ(*numbers.begin(), 2);
+
+    auto finite = words(-1);
+    ASSERT_EQ(count::count(finite), 5u);
+    ASSERT_EQ(count::count(finite), 0u);
+}
+
+TEST(GeneratorSourceTest, Finite) {
+    auto all = words(-1);
+
+    ASSERT_EQ(std::vector<std::string>(all.begin(), all.end()), (std::vector<std::string>{ "w0", "w1", "w2", "w3", "w4" }));
+    ASSERT_EQ(count::count(words(-1) | filter::filter([](const std::string& w) { return w != "w2"; })), 4u);
+    ASSERT_THROW(count::count(words(3)), std::runtime_error);
+}
+#endif
+
+TEST(CacheTest, ComputesOncePerElement) {
+    std::vector<int> vec(100);
+    std::iota(vec.begin(), vec.end(), 0);
+    int calls = 0;
+    auto cached = vec | transform::transform([&calls](int x) { ++calls; return x * 2; }) | cache::cache();
+
+    std::vector<int> expected = collect::collect(vec | transform::transform([](int x) { return x * 2; }));
+    ASSERT_EQ(std::vector<int>(cached.begin(), cached.end()), expected);
+    ASSERT_EQ(collect::collect(cached), expected);
+    ASSERT_EQ(reduce::reduce(cached, 0, std::plus<int>()), 9900);
+    ASSERT_EQ(cached.size(), 100u);
+    ASSERT_EQ(calls, 100);
+}
+
+TEST(CacheTest, FetchesLazily) {
+    std::list<int> lst = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    int calls = 0;
+    auto cached = lst | filter::filter([&calls](int x) { ++calls; return x % 2 == 0; }) | cache::cache();
+    auto copy = cached;
+
+    ASSERT_EQ(collect::collect(cached | take::take(2)), (std::vector<int>{ 2, 4 }));
+    ASSERT_EQ(calls, 4);
+    ASSERT_EQ(collect::collect(copy), (std::vector<int>{ 2, 4, 6, 8 }));
+    ASSERT_EQ(calls, 8);
+    ASSERT_EQ(count::count(cached), 4u);
+    ASSERT_EQ(calls, 8);
+}
+
+TEST(CacheTest, UnboundedSource) {
+    int calls = 0;
+    auto cached = iota::iota(0L) | cache::cache();
+    auto squares = iota::iota(0) | transform::transform([&calls](int x) { ++calls; return x * x; }) | cache::cache();
+
+    ASSERT_EQ(collect::collect(cached | take::take(3)), (std::vector<long>{ 0, 1, 2 }));
+    ASSERT_EQ(collect::collect(squares | take::take(3)), (std::vector<int>{ 0, 1, 4 }));
+    ASSERT_EQ(collect::collect(squares | take::take(3)), (std::vector<int>{ 0, 1, 4 }));
+    ASSERT_EQ(calls, 3);
+}
+
+TEST(CacheTest, RetriesAfterException) {
+    std::vector<int> vec = { 1, 2, 3 };
+    bool fail = true;
+    auto cached = vec | transform::transform([&fail](int x) {
+        if (x == 2 && fail) {
+            throw std::runtime_error("failed");
+        }
+        return x;
+    }) | cache::cache();
+
+    ASSERT_THROW(collect::collect(cached), std::runtime_error);
+    fail = false;
+    ASSERT_EQ(collect::collect(cached), (std::vector<int>{ 1, 2, 3 }));
+}
+
+TEST(CacheTest, ParallelAndBlocks) {
+    std::vector<int> vec(10000);
+    std::iota(vec.begin(), vec.end(), 0);
+    auto cached = vec | filter::filter([](int x) { return x % 3 == 0; }) | cache::cache();
+    auto pipeline = cached | transform::transform([](int x) { return x + 1; });
+
+    static_assert(detail::is_blocked_v<decltype(pipeline)>, "");
+    ASSERT_EQ(collect::collect(execution::parallel_policy{ 3, 100 }, pipeline), std::vector<int>(pipeline.begin(), pipeline.end()));
+    ASSERT_EQ(collect::collect(pipeline), std::vector<int>(pipeline.begin(), pipeline.end()));
+}
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+TEST(CacheTest, MakesGeneratorsMultiPass) {
+    auto cached = words(-1) | cache::cache();
+
+    ASSERT_EQ(count::count(cached), 5u);
+    ASSERT_EQ(collect::collect(cached), (std::vector<std::string>{ "w0", "w1", "w2", "w3", "w4" }));
+    ASSERT_EQ(collect::collect(naturals() | filter::filter([](int x) { return x < 3; }) | cache::cache() | take::take(3)),
+        (std::vector<int>{ 0, 1, 2 }));
+}
+#endif
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();